@@ -0,0 +1,32 @@
+#ifndef COLOR_SCAN_H
+#define COLOR_SCAN_H
+
+#include <basic_types.h>
+#include <stddef.h>
+
+#include <constants.h>
+
+/* rows of shuffle tables, row index of a queen selects its entry */
+constexpr uint8 COLOR_SCAN_TABLE_SIZE = 16u;
+
+/*
+    column-major boards and colors of their cells. Color of a cell is a bit within lower (colors 1-8) or higher (colors 9-16) byte,
+    so that color lookups of 16 or 32 boards at once are single byte shuffles
+*/
+typedef struct
+{
+    const uint8* columns[QUEENS_MAX_BOARD_SIZE];                   /* row of the queen of every board, one array per column */
+    uint8 columns_count;
+    uint8 lower_colors[QUEENS_MAX_BOARD_SIZE][COLOR_SCAN_TABLE_SIZE];  /* per column: row -> bit (color - 1) for colors 1-8 */
+    uint8 higher_colors[QUEENS_MAX_BOARD_SIZE][COLOR_SCAN_TABLE_SIZE]; /* per column: row -> bit (color - 9) for colors 9-16 */
+    uint8 lower_all_colors;                                        /* lower bits of board with every color covered */
+    uint8 higher_all_colors;
+} ColorScan_Table_t;
+
+void ColorScan_SetColor(ColorScan_Table_t* table, const uint8 column, const uint8 row, const uint8 color); /* color 1-16 */
+size_t ColorScan_Count(const ColorScan_Table_t* const table, size_t first_board, size_t boards_count); /* boards whose queens cover all colors of the table */
+size_t ColorScan_CountScalar(const ColorScan_Table_t* const table, size_t first_board, size_t boards_count); /* reference implementation */
+size_t ColorScan_CountParallel(const ColorScan_Table_t* const table, size_t boards_count, size_t max_count, uint8 threads_count); /* every thread stops once max_count is reached, threads_count 0 - one per core */
+const char* ColorScan_GetImplementation(void);
+
+#endif /* COLOR_SCAN_H */
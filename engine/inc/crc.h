@@ -4,5 +4,6 @@
 #include <basic_types.h>
 
 uint16 CRC_CalculateCRC16(const uint8 *data, size_t length);
+uint16 CRC_UpdateCRC16(uint16 crc, const uint8 *data, size_t length);
 
 #endif /* CRC_H */
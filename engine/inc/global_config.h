@@ -8,13 +8,32 @@ typedef struct
     /* General */
     bool debug_print_enabled;
     /* QueensPermutations */
+    const char* permutations_cache_dir; /* directory of cached permutations files (created if missing), NULL - current working directory */
     bool permutations_compressed;
+    bool permutations_symmetry_reduced; /* store only one board per symmetry orbit, expand on load */
+    bool permutations_prefix_tree; /* store permutations as prefix tree (ignored if symmetry reduced), GetAll returns tree instead of flat boards */
+    bool permutations_checkpoint; /* raw/compressed cached file is built from per-prefix part files, interrupted build resumes from them */
+    bool permutations_sharded; /* raw/compressed store split into files by rows of leading columns, loaded shard by shard */
+    bool permutations_mmap; /* map cached permutations file read-only instead of reading it into heap */
+    bool permutations_keep_packed; /* keep compressed tables nibble-packed in heap instead of one byte per column */
+    uint8 permutations_generate_threads; /* 0 - one thread per core */
+    uint8 permutations_unpack_threads; /* threads unpacking large loaded tables, 0 - one thread per core */
+    bool permutations_sample_from_counts; /* draw random permutations from completion counts, no cached file is needed */
+    size_t permutations_table_max_size; /* bytes, larger full tables are never built - table-free paths are used instead, 0 - unlimited */
+    size_t permutations_registry_budget; /* bytes of tables kept loaded by QueensPermutationsRegistry, 0 - unlimited */
+    bool permutations_column_major; /* tables kept by QueensPermutationsRegistry are transposed to one array per column, scanned with vector shuffles */
+    uint32 permutations_warmup_sizes; /* bit per board size, uniqueness backend decided and its table, index or shards loaded by background thread at start, 0 - no warm-up */
 
     /* QueensBoardGen */
     uint8 boardgen_cell_skip_chance;
     uint8 boardgen_neighbor_skip_chance;
     uint8 boardgen_only_horizontal_neighbor_chance;
     uint8 boardgen_only_vertical_neighbor_chance;
+    uint8 boardgen_uniqueness_backend; /* QueensBoardGen_Backend_t used when no table is provided, 0 - picked per board size */
+    bool boardgen_incremental_check; /* solutions of partially colored board are checked during generation, candidates with second solution are dropped early */
+    bool boardgen_bit_parallel_fill; /* regions grow by shifted masks of whole board per pass instead of cell by cell */
+    bool boardgen_repair; /* board failing validation gets cells under queens of other solutions recolored instead of being regenerated */
+    uint8 boardgen_scan_threads; /* threads scanning column-major tables, 0 - one thread per core */
 
     /* QueensBoard */
     bool board_sparse_print;
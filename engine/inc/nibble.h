@@ -0,0 +1,15 @@
+#ifndef NIBBLE_H
+#define NIBBLE_H
+
+#include <basic_types.h>
+
+/*
+    unpacks nibbles_count nibbles (higher nibble of every byte first) starting at nibble first_nibble of src, one byte per nibble.
+    dest may be the very buffer src is stored in if first_nibble is 0 (in-place expansion)
+*/
+void Nibble_Unpack(uint8* dest, const uint8* src, size_t first_nibble, size_t nibbles_count);
+void Nibble_UnpackScalar(uint8* dest, const uint8* src, size_t first_nibble, size_t nibbles_count); /* reference implementation */
+void Nibble_UnpackParallel(uint8* dest, const uint8* src, size_t first_nibble, size_t nibbles_count, uint8 threads_count); /* dest and src must not overlap, threads_count 0 - one per core */
+const char* Nibble_GetUnpackImplementation(void);
+
+#endif /* NIBBLE_H */
@@ -0,0 +1,21 @@
+#ifndef QUEENS_BENCHMARK_H
+#define QUEENS_BENCHMARK_H
+
+#include <basic_types.h>
+#include <stdbool.h>
+
+typedef int (*QueensBenchmark_Function_t)(int, char **);
+
+typedef struct
+{
+    const char *name;
+    QueensBenchmark_Function_t function;
+    const char *description;
+    const char *args;
+} QueensBenchmark_Benchmark_t;
+
+/* argc/argv are the arguments following benchmark name */
+int QueensBenchmark_Run(const char* name, int argc, char **argv);
+void QueensBenchmark_PrintList(void);
+
+#endif /* QUEENS_BENCHMARK_H */
@@ -2,6 +2,7 @@
 #define QUEENS_BOARD_H
 
 #include <constants.h>
+#include <stdio.h>
 
 #define IDX(row, column, size) ((row) * (size) + (column))
 
@@ -31,6 +32,7 @@ void QueensBoard_Free(QueensBoard_Board_t* board);
 void QueensBoard_ZeroeBoard(QueensBoard_Board_t* board);
 void QueensBoard_PrintBoard(const QueensBoard_Board_t* const board);
 void QueensBoard_PrintBoardAsString(const QueensBoard_Board_t* board);
+void QueensBoard_WriteBoardAsString(const QueensBoard_Board_t* board, FILE* file); /* same format as QueensBoard_PrintBoardAsString */
 bool QueensBoard_ParseFromString(const char* board_str, QueensBoard_Board_t* board);
 
 QueensBoard_Cell_t QueensBoard_GetColor(const QueensBoard_Cell_t cell);
@@ -7,10 +7,46 @@
 typedef enum
 {
     QUEENS_BOARDGEN_SUCCESS = 0,
-    QUEENS_BOARDGEN_ERROR = 1
+    QUEENS_BOARDGEN_ERROR = 1,
+    QUEENS_BOARDGEN_ITERATIONS_EXCEEDED = 2 /* no board with exactly one solution within allowed number of iterations */
 } QueensBoardGen_Result_t;
 
+/* how solutions are counted when no permutations table is provided */
+typedef enum
+{
+    QUEENS_BOARDGEN_BACKEND_AUTO = 0,   /* picked per board size from memory budget and measured throughput */
+    QUEENS_BOARDGEN_BACKEND_TABLE = 1,  /* scan of full table held by QueensPermutationsRegistry */
+    QUEENS_BOARDGEN_BACKEND_STREAM = 2, /* scan of permutations streamed in batches */
+    QUEENS_BOARDGEN_BACKEND_SHARDS = 3, /* scan of shards whose prefix queens are on different colors */
+    QUEENS_BOARDGEN_BACKEND_SEARCH = 4, /* backtracking over permutations pruned by colors, no table */
+    QUEENS_BOARDGEN_BACKEND_INDEX = 5,  /* AND of per-color cell bitmaps of QueensPermutationsIndex */
+    QUEENS_BOARDGEN_BACKEND_MEMO = 6    /* search with completions of reached (rows, colors, previous row) states memoised, no table */
+} QueensBoardGen_Backend_t;
+
+typedef struct
+{
+    QueensBoardGen_Backend_t backend; /* AUTO - still measuring, search is used meanwhile */
+    uint64 table_size;                /* bytes the full table would take */
+    double table_scan_time;           /* s per board, estimated from scan rate of a small table */
+    double search_time;               /* s per board, median of measured searches */
+    uint32 search_samples;
+    uint64 index_size;                /* bytes of the index, 0 - over the budget, not measured */
+    double index_time;                /* s per board, median of index counts on the same boards as search */
+    double memo_time;                 /* s per board, median of memoised searches on the same boards as search */
+} QueensBoardGen_BackendStats_t;
+
+/* called for every accepted board of a batch, never from two threads at once. false - no more boards are wanted */
+typedef bool (*QueensBoardGen_BatchCallback_t)(void* context, const QueensBoard_Board_t* const board);
+
 QueensBoardGen_Result_t QueensBoardGen_Generate(QueensBoard_Board_t* board, QueensPermutations_Result_t* permutation);
+QueensBoardGen_Result_t QueensBoardGen_GenerateUnique(QueensBoard_Board_t* board, const uint32 max_iterations, uint32* iterations); /* generates until board has exactly one solution, max_iterations 0 - unlimited */
+uint32 QueensBoardGen_GenerateBatch(const QueensBoard_Size_t board_size, const uint32 boards_count, uint8 threads_count, const QueensBoardGen_BatchCallback_t callback, void* const context); /* unique boards generated by worker threads, each with its own random stream, threads_count 0 - one per core. Returns number of boards passed to callback */
 bool QueensBoardGen_ValidateOnlyOneSolution(const QueensBoard_Board_t* board, const QueensPermutations_Result_t* permutations);
+bool QueensBoardGen_ValidateOnlyOneSolutionWith(const QueensBoard_Board_t* board, const QueensPermutations_Result_t* permutations, QueensBoardGen_Backend_t backend); /* backend is ignored if permutations are provided */
+QueensBoardGen_Backend_t QueensBoardGen_GetBackend(const QueensBoard_Size_t board_size); /* backend AUTO resolves to for given size */
+QueensBoardGen_BackendStats_t QueensBoardGen_GetBackendStats(const QueensBoard_Size_t board_size);
+const char* QueensBoardGen_GetBackendName(const QueensBoardGen_Backend_t backend);
+/* on background thread decides AUTO backend of given sizes and loads what it uses (table, index or shards), bit N - board size N */
+bool QueensBoardGen_StartWarmUp(const uint32 board_sizes_mask);
 
 #endif /* QUEENS_BOARDGEN_H */
@@ -14,13 +14,131 @@ typedef uint8 QueensPermutation_BoardSize_t;
 typedef struct
 {
     QueensPermutations_QueenRowIndex_t* boards;
-    uint32 boards_count;
+    uint64 boards_count;
     QueensPermutation_BoardSize_t board_size;
     bool success;
+    bool packed;          /* boards kept in file layout, two columns per byte (higher nibble first) */
+    void* mapping;        /* non-NULL if boards point into a read-only mapping of the permutations file */
+    size_t mapping_size;
+    bool prefix_tree;     /* boards holds prefix tree of tree_size bytes instead of boards, read with QueensPermutations_TraverseTree */
+    size_t tree_size;
+    bool column_major;    /* boards holds board_size columns of boards_count rows each, see QueensPermutations_ToColumnMajor */
 } QueensPermutations_Result_t;
 
+/* where QueensPermutations_Cursor takes permutations from */
+typedef enum
+{
+    QUEENS_PERMUTATIONS_CURSOR_SOURCE_AUTO = 0,       /* cached file if it exists, live enumeration otherwise */
+    QUEENS_PERMUTATIONS_CURSOR_SOURCE_FILE = 1,       /* cached file, generated first if missing */
+    QUEENS_PERMUTATIONS_CURSOR_SOURCE_ENUMERATOR = 2  /* live enumeration, nothing is read from disk */
+} QueensPermutations_CursorSource_t;
+
+/* QueensPermutations_TraverseTree visitor decision after a queen is placed */
+typedef enum
+{
+    QUEENS_PERMUTATIONS_VISIT_DESCEND = 0, /* continue with permutations starting with current prefix */
+    QUEENS_PERMUTATIONS_VISIT_SKIP = 1,    /* prefix can't lead to anything useful, skip its whole subtree */
+    QUEENS_PERMUTATIONS_VISIT_STOP = 2     /* end traversal */
+} QueensPermutations_Visit_t;
+
+/* called for every prefix, queen in given column is placed in given row (column board_size - 1 completes a permutation) */
+typedef QueensPermutations_Visit_t (*QueensPermutations_TreeVisitor_t)(void* context, const uint8 column, const QueensPermutations_QueenRowIndex_t row);
+
+/* number of permutations yielded by single QueensPermutations_CursorNextBatch call (except the last one) */
+constexpr uint32 QUEENS_PERMUTATIONS_CURSOR_BATCH_SIZE = 4096u;
+
+/* sharded store: one permutations file per rows of queens in this many leading columns */
+constexpr uint8 QUEENS_PERMUTATIONS_SHARD_PREFIX_LEN = 2u;
+
+typedef struct QueensPermutations_Cursor QueensPermutations_Cursor_t;
+typedef struct QueensPermutations_Source QueensPermutations_Source_t;
+typedef struct QueensPermutations_Shards QueensPermutations_Shards_t;
+
 [[maybe_unused]] QueensPermutations_Result_t QueensPermutations_GetAll(QueensPermutation_BoardSize_t board_size);
 [[maybe_unused]] QueensPermutations_Result_t QueensPermutations_GetRandom(const QueensPermutation_BoardSize_t board_size);
+[[maybe_unused]] QueensPermutations_Result_t QueensPermutations_Generate(const QueensPermutation_BoardSize_t board_size, uint8 threads_count); /* threads_count 0 - one per core */
+[[maybe_unused]] bool QueensPermutations_BuildFile(const QueensPermutation_BoardSize_t board_size); /* (re)generates cached permutations file, waits for the file instead if another process is already generating it */
 bool QueensPermutations_FreeResult(const QueensPermutations_Result_t* result);
+QueensPermutations_Result_t QueensPermutations_ToColumnMajor(const QueensPermutations_Result_t* const table); /* unpacked copy with one contiguous array per column, not for prefix tree */
+uint64 QueensPermutations_GetCount(const QueensPermutation_BoardSize_t board_size); /* number of permutations, nothing is generated */
+bool QueensPermutations_TableFits(const QueensPermutation_BoardSize_t board_size); /* full table is within permutations_table_max_size */
+[[maybe_unused]] bool QueensPermutations_TraverseTree(const QueensPermutations_Result_t* const tree, const QueensPermutations_TreeVisitor_t visitor, void* const context); /* depth-first, prefixes in lexicographic order */
+
+/* streaming access to all permutations in fixed-size batches, memory use doesn't depend on the number of permutations */
+QueensPermutations_Cursor_t* QueensPermutations_CursorOpen(const QueensPermutation_BoardSize_t board_size, const QueensPermutations_CursorSource_t source);
+bool QueensPermutations_CursorNextBatch(QueensPermutations_Cursor_t* cursor, QueensPermutations_Result_t* batch); /* batch is valid until next call, false if no more permutations */
+bool QueensPermutations_CursorFailed(const QueensPermutations_Cursor_t* cursor); /* cached file turned out to be corrupted (it is removed) */
+void QueensPermutations_CursorClose(QueensPermutations_Cursor_t* cursor);
+
+/* random access to cached permutations file, kept open (or mapped) between calls */
+QueensPermutations_Source_t* QueensPermutations_SourceOpen(const QueensPermutation_BoardSize_t board_size); /* generates file first if missing or not valid */
+uint64 QueensPermutations_SourceGetCount(const QueensPermutations_Source_t* const source);
+bool QueensPermutations_SourceGetRandom(const QueensPermutations_Source_t* const source, QueensPermutations_QueenRowIndex_t* const board); /* board has to have board_size elements, nothing is allocated */
+void QueensPermutations_SourceClose(QueensPermutations_Source_t* source);
+QueensPermutations_Source_t* QueensPermutations_GetSource(const QueensPermutation_BoardSize_t board_size); /* shared per-size source, must not be closed by the caller */
+void QueensPermutations_CloseSharedSources(void);
+
+/* sharded store (global_config.permutations_sharded), any shard can be loaded on its own */
+QueensPermutations_Shards_t* QueensPermutations_ShardsOpen(const QueensPermutation_BoardSize_t board_size); /* builds shard files first if missing, NULL for symmetric and prefix tree stores */
+uint32 QueensPermutations_ShardsGetCount(const QueensPermutations_Shards_t* const shards);
+const QueensPermutations_QueenRowIndex_t* QueensPermutations_ShardsGetPrefix(const QueensPermutations_Shards_t* const shards, const uint32 shard_idx); /* QUEENS_PERMUTATIONS_SHARD_PREFIX_LEN rows */
+QueensPermutations_Result_t QueensPermutations_ShardsLoad(const QueensPermutations_Shards_t* const shards, const uint32 shard_idx); /* has to be freed with QueensPermutations_FreeResult */
+void QueensPermutations_ShardsClose(QueensPermutations_Shards_t* shards);
+QueensPermutations_Shards_t* QueensPermutations_GetShards(const QueensPermutation_BoardSize_t board_size); /* shared per-size shards, must not be closed by the caller */
+
+/* row of the queen placed in given column of given board, works for packed, unpacked and column-major results (not for prefix tree) */
+static inline QueensPermutations_QueenRowIndex_t QueensPermutations_GetRow(const QueensPermutations_Result_t* const result, const uint64 board_idx, const uint8 column)
+{
+    if (result->column_major == true)
+    {
+        return result->boards[(size_t)column * result->boards_count + board_idx];
+    }
+
+    const size_t column_idx = (size_t)board_idx * result->board_size + column;
+
+    if (result->packed == false)
+    {
+        return result->boards[column_idx];
+    }
+
+    const uint8 packed_byte = (uint8)result->boards[column_idx / 2u];
+
+    if ((column_idx % 2u) == 0u)
+    {
+        return (QueensPermutations_QueenRowIndex_t)(packed_byte >> NIBBLE_LEN);
+    }
+
+    return (QueensPermutations_QueenRowIndex_t)(packed_byte & 0x0F);
+}
+
+/* whole board, pointer into result if it is unpacked, otherwise board is unpacked (or gathered from columns) into buffer (board_size elements) */
+static inline const QueensPermutations_QueenRowIndex_t* QueensPermutations_GetBoard(const QueensPermutations_Result_t* const result, const uint64 board_idx, QueensPermutations_QueenRowIndex_t* const buffer)
+{
+    if (result->column_major == true)
+    {
+        for (uint8 column = 0u; column < result->board_size; column++)
+        {
+            buffer[column] = result->boards[(size_t)column * result->boards_count + board_idx];
+        }
+
+        return buffer;
+    }
+
+    const size_t first_column_idx = (size_t)board_idx * result->board_size;
+
+    if (result->packed == false)
+    {
+        return &result->boards[first_column_idx];
+    }
+
+    for (uint8 column = 0u; column < result->board_size; column++)
+    {
+        const size_t column_idx = first_column_idx + column;
+        const uint8 packed_byte = (uint8)result->boards[column_idx / 2u];
+        buffer[column] = (QueensPermutations_QueenRowIndex_t)(((column_idx % 2u) == 0u) ? (packed_byte >> NIBBLE_LEN) : (packed_byte & 0x0F));
+    }
+
+    return buffer;
+}
 
 #endif /* QUEENS_PERMUTATIONS_H */
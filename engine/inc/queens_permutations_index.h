@@ -0,0 +1,28 @@
+#ifndef QUEENS_PERMUTATIONS_INDEX_H
+#define QUEENS_PERMUTATIONS_INDEX_H
+
+#include <basic_types.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <queens_permutations.h>
+#include <queens_board.h>
+
+/*
+    inverted index of all permutations of one board size: bitmap per cell of permutations putting a queen on it.
+    Queens of two leading columns are not kept as bitmaps, permutations are grouped by them instead (runs in enumeration order)
+*/
+typedef struct QueensPermutationsIndex QueensPermutationsIndex_t;
+
+QueensPermutationsIndex_t* QueensPermutationsIndex_Build(const QueensPermutation_BoardSize_t board_size);
+void QueensPermutationsIndex_Free(QueensPermutationsIndex_t* index);
+uint32 QueensPermutationsIndex_CountSolutions(const QueensPermutationsIndex_t* const index, const QueensBoard_Board_t* const board, const uint32 max_solutions); /* stops once max_solutions is reached */
+size_t QueensPermutationsIndex_GetSize(const QueensPermutationsIndex_t* const index); /* bytes */
+uint64 QueensPermutationsIndex_EstimateSize(const QueensPermutation_BoardSize_t board_size); /* bytes, nothing is built */
+/* shared per-size index built on first use, NULL if over permutations_registry_budget. Has to be released with QueensPermutationsIndex_Release */
+const QueensPermutationsIndex_t* QueensPermutationsIndex_Acquire(const QueensPermutation_BoardSize_t board_size);
+void QueensPermutationsIndex_Release(const QueensPermutationsIndex_t* index);
+void QueensPermutationsIndex_Drop(const QueensPermutation_BoardSize_t board_size); /* frees shared index once it is not in use, next acquire builds it again */
+void QueensPermutationsIndex_Clear(void); /* frees shared indexes, none may be in use */
+
+#endif /* QUEENS_PERMUTATIONS_INDEX_H */
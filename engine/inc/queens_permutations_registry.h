@@ -0,0 +1,27 @@
+#ifndef QUEENS_PERMUTATIONS_REGISTRY_H
+#define QUEENS_PERMUTATIONS_REGISTRY_H
+
+#include <basic_types.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <queens_permutations.h>
+
+typedef struct
+{
+    uint64 hits;            /* table was already loaded */
+    uint64 misses;          /* table had to be loaded (or generated) */
+    uint64 evictions;
+    size_t resident_size;   /* bytes held by loaded tables */
+    size_t budget;          /* 0 - unlimited */
+} QueensPermutationsRegistry_Stats_t;
+
+/* shared read-only table for given board size, loaded on first use. Has to be released with QueensPermutationsRegistry_Release */
+const QueensPermutations_Result_t* QueensPermutationsRegistry_Acquire(const QueensPermutation_BoardSize_t board_size);
+void QueensPermutationsRegistry_Release(const QueensPermutations_Result_t* table);
+QueensPermutationsRegistry_Stats_t QueensPermutationsRegistry_GetStats(void);
+void QueensPermutationsRegistry_Clear(void); /* frees all tables that are not in use */
+/* loads (maps and pre-faults) tables of given sizes, bit N - board size N. Acquire of size being loaded from other thread waits for it */
+void QueensPermutationsRegistry_WarmUp(const uint32 board_sizes_mask);
+
+#endif /* QUEENS_PERMUTATIONS_REGISTRY_H */
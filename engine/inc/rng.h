@@ -5,7 +5,17 @@
 #include <basic_types.h>
 #include <time.h>
 
-void RNG_Seed(uint64 seed);
+/* generator state of one thread, lets a thread run on other stream for a while and continue where it was */
+typedef struct
+{
+    uint64 state;
+    uint64 increment;
+} RNG_State_t;
+
+void RNG_Seed(uint64 seed); /* seeds generator of calling thread, other threads keep their own state */
+void RNG_SeedStream(uint64 seed, uint64 stream); /* same seed with different stream gives independent sequence */
+RNG_State_t RNG_GetState(void);
+void RNG_SetState(const RNG_State_t rng_state);
 uint64 RNG_Random_u64();
 uint32 RNG_Random_u32();
 uint16 RNG_Random_u16();
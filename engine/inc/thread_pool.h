@@ -0,0 +1,19 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <basic_types.h>
+#include <stddef.h>
+
+constexpr uint8 THREAD_POOL_MAX_THREADS = 64u;
+
+typedef void* (*ThreadPool_Worker_t)(void* arg);
+
+/* threads_count 0 - one per online core. Capped at THREAD_POOL_MAX_THREADS and at jobs_count, at least 1 */
+uint8 ThreadPool_GetThreadsCount(uint8 threads_count, const size_t jobs_count);
+/*
+    runs worker on every job, one thread each, and returns once all of them are done. Calling thread runs the first job and jobs of threads
+    that failed to start. job_size 0 - every thread gets jobs itself (one job shared by threads that claim work from it)
+*/
+void ThreadPool_Run(const ThreadPool_Worker_t worker, void* const jobs, const size_t job_size, const uint8 jobs_count);
+
+#endif /* THREAD_POOL_H */
@@ -4,8 +4,11 @@
 #include <queens_permutations.h>
 #include <queens_boardgen.h>
 #include <queens_solver.h>
+#include <queens_benchmark.h>
+#include <global_config.h>
 #include <string.h>
 #include <stdlib.h>
+#include <time.h>
 
 typedef int (*ArgParser_Command_t)(int, char **, size_t);
 
@@ -20,17 +23,23 @@ typedef struct
 int ArgParser_Version(int argc, char **argv, size_t command_idx);
 int ArgParser_Help(int argc, char **argv, size_t command_idx);
 int ArgParser_Generate(int argc, char **argv, size_t command_idx);
+int ArgParser_GenerateBatch(int argc, char **argv, size_t command_idx);
 int ArgParser_GenerateAndSolve(int argc, char **argv, size_t command_idx);
 int ArgParser_SolveStep(int argc, char **argv, size_t command_idx);
 int ArgParser_PrintFromString(int argc, char **argv, size_t command_idx);
+int ArgParser_GeneratePermutations(int argc, char **argv, size_t command_idx);
+int ArgParser_Benchmark(int argc, char **argv, size_t command_idx);
 
 ArgParser_Commands_t commands[] = {
     {"--help",               ArgParser_Help,             "Show help",          ""},
     {"--version",            ArgParser_Version,          "Show version",       ""},
     {"--generate",           ArgParser_Generate,         "Generate new board", "<board_size>"},
+    {"--generate_batch",     ArgParser_GenerateBatch,    "Generate many boards on all cores, one board string per line", "<board_size> <count> [<threads>] [<output_file>]"},
     {"--generate_and_solve", ArgParser_GenerateAndSolve, "Generate new board and show solving process", "<board_size>"},
     {"--solve_step",         ArgParser_SolveStep,        "Returns board with one new solving step", "<board_string>"},
     {"--print_from_string",  ArgParser_PrintFromString,  "Prints board from board string", "<board_string>"},
+    {"--generate_permutations", ArgParser_GeneratePermutations, "(Re)builds cached permutations file", "<board_size> [<threads>]"},
+    {"--benchmark",          ArgParser_Benchmark,        "Run benchmark", "<benchmark_name> [<args>]"},
     //{"--solve",    ArgParser_Solve,    "Given a map, solve it. Args: <map> <type (all/single)>"}
 };
 
@@ -93,7 +102,6 @@ int ArgParser_Generate(int argc, char **argv, size_t command_idx)
         return 1;
     }
 
-    QueensPermutations_Result_t all_permutations = QueensPermutations_GetAll((QueensPermutation_BoardSize_t)board_size);
     QueensBoard_Board_t board = {0};
     bool ret = QueensBoard_Create(&board, (QueensBoard_Size_t)board_size);
     if (ret == false)
@@ -102,23 +110,99 @@ int ArgParser_Generate(int argc, char **argv, size_t command_idx)
         return 1;
     }
 
-    int n = 0;
+    uint32 n = 0u;
 
-    do
+    if (QueensBoardGen_GenerateUnique(&board, 0u, &n) != QUEENS_BOARDGEN_SUCCESS)
+    {
+        debug_print("Error generating board!\n");
+        return 1;
+    }
+
+    debug_print("\n");
+    QueensBoard_PrintBoard(&board);
+
+    debug_print("Number of iterations: %u\n", n);
+
+    return 0;
+}
+
+/* boards are written as soon as they are accepted, so that an interrupted batch keeps what was made */
+static bool ArgParser_WriteBatchBoard(void* context, const QueensBoard_Board_t* const board)
+{
+    FILE* output = (FILE*)context;
+
+    QueensBoard_WriteBoardAsString(board, output);
+    fputc('\n', output);
+
+    return (fflush(output) == 0);
+}
+
+int ArgParser_GenerateBatch(int argc, char **argv, size_t command_idx)
+{
+    if (argc < 4)
+    {
+        printf("Invalid number of arguments! Expected \"%s %s\"\n", argv[0], commands[command_idx].args);
+        return 1;
+    }
+
+    int board_size = atoi(argv[2]);
+    long boards_count = atol(argv[3]);
+    int threads_count = (argc >= 5) ? atoi(argv[4]) : 0;
+
+    if (board_size < QUEENS_MIN_BOARD_SIZE || board_size > QUEENS_MAX_BOARD_SIZE)
+    {
+        printf("Invalid board size! Expected board size between %d and %d\n", QUEENS_MIN_BOARD_SIZE, QUEENS_MAX_BOARD_SIZE);
+        return 1;
+    }
+
+    if (boards_count < 1 || boards_count > UINT32_MAX)
+    {
+        printf("Invalid number of boards!\n");
+        return 1;
+    }
+
+    if (threads_count < 0 || threads_count > UINT8_MAX)
+    {
+        printf("Invalid number of threads!\n");
+        return 1;
+    }
+
+    /* stdout carries only boards, summary goes to stdout only if boards go to a file */
+    FILE* output = stdout;
+    if (argc >= 6)
     {
-        QueensBoardGen_Result_t ret = QueensBoardGen_Generate(&board, NULL);
-        if (ret != QUEENS_BOARDGEN_SUCCESS)
+        output = fopen(argv[5], "w");
+        if (output == NULL)
         {
-            debug_print("Error generating board!\n");
+            printf("Error opening output file %s!\n", argv[5]);
             return 1;
         }
-        n++;
-    } while (QueensBoardGen_ValidateOnlyOneSolution(&board, &all_permutations) == false);
+    }
 
-    debug_print("\n");
-    QueensBoard_PrintBoard(&board);
+    struct timespec start_time;
+    struct timespec end_time;
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+    uint32 generated_count = QueensBoardGen_GenerateBatch((QueensBoard_Size_t)board_size, (uint32)boards_count, (uint8)threads_count, ArgParser_WriteBatchBoard, output);
+
+    clock_gettime(CLOCK_MONOTONIC, &end_time);
+    double elapsed_time = (double)(end_time.tv_sec - start_time.tv_sec) + (double)(end_time.tv_nsec - start_time.tv_nsec) / 1e9;
+
+    if (output != stdout)
+    {
+        fclose(output);
+        printf("Generated %u of %ld boards in %.3f s (%.3f boards/s)\n", generated_count, boards_count, elapsed_time, (elapsed_time > 0.0) ? ((double)generated_count / elapsed_time) : 0.0);
+    }
+    else
+    {
+        debug_print("Generated %u of %ld boards in %.3f s\n", generated_count, boards_count, elapsed_time);
+    }
 
-    debug_print("Number of iterations: %d\n", n);
+    if (generated_count < (uint32)boards_count)
+    {
+        printf("Error generating boards!\n");
+        return 1;
+    }
 
     return 0;
 }
@@ -139,7 +223,6 @@ int ArgParser_GenerateAndSolve(int argc, char **argv, size_t command_idx)
         return 1;
     }
 
-    QueensPermutations_Result_t all_permutations = QueensPermutations_GetAll((QueensPermutation_BoardSize_t)board_size);
     QueensBoard_Board_t board = {0};
     bool ret = QueensBoard_Create(&board, (QueensBoard_Size_t)board_size);
     if (ret == false)
@@ -148,23 +231,18 @@ int ArgParser_GenerateAndSolve(int argc, char **argv, size_t command_idx)
         return 1;
     }
 
-    int n = 0;
+    uint32 n = 0u;
 
-    do
+    if (QueensBoardGen_GenerateUnique(&board, 0u, &n) != QUEENS_BOARDGEN_SUCCESS)
     {
-        QueensBoardGen_Result_t ret = QueensBoardGen_Generate(&board, NULL);
-        if (ret != QUEENS_BOARDGEN_SUCCESS)
-        {
-            debug_print("Error generating board!\n");
-            return 1;
-        }
-        n++;
-    } while (QueensBoardGen_ValidateOnlyOneSolution(&board, &all_permutations) == false);
+        debug_print("Error generating board!\n");
+        return 1;
+    }
 
     debug_print("\n");
     QueensBoard_PrintBoard(&board);
 
-    debug_print("Number of iterations: %d\n", n);
+    debug_print("Number of iterations: %u\n", n);
 
     QueensSolver_Strategy_t strategy = QUEENS_SOLVER_FAILED;
 
@@ -253,3 +331,52 @@ int ArgParser_PrintFromString(int argc, char **argv, size_t command_idx)
 
     return 0;
 }
+
+int ArgParser_GeneratePermutations(int argc, char **argv, size_t command_idx)
+{
+    if (argc < 3)
+    {
+        printf("Invalid number of arguments! Expected \"%s %s\"\n", argv[0], commands[command_idx].args);
+        return 1;
+    }
+
+    int board_size = atoi(argv[2]);
+
+    if (board_size < QUEENS_MIN_BOARD_SIZE || board_size > QUEENS_MAX_BOARD_SIZE)
+    {
+        printf("Invalid board size! Expected board size between %d and %d\n", QUEENS_MIN_BOARD_SIZE, QUEENS_MAX_BOARD_SIZE);
+        return 1;
+    }
+
+    if (argc >= 4)
+    {
+        int threads_count = atoi(argv[3]);
+        if (threads_count < 0 || threads_count > UINT8_MAX)
+        {
+            printf("Invalid number of threads!\n");
+            return 1;
+        }
+
+        global_config.permutations_generate_threads = (uint8)threads_count;
+    }
+
+    if (QueensPermutations_BuildFile((QueensPermutation_BoardSize_t)board_size) == false)
+    {
+        printf("Error generating permutations!\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+int ArgParser_Benchmark(int argc, char **argv, size_t command_idx)
+{
+    if (argc < 3)
+    {
+        printf("Invalid number of arguments! Expected \"%s %s\"\n", argv[0], commands[command_idx].args);
+        QueensBenchmark_PrintList();
+        return 1;
+    }
+
+    return QueensBenchmark_Run(argv[2], argc - 3, &argv[3]);
+}
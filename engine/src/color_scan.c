@@ -0,0 +1,250 @@
+#include <color_scan.h>
+#include <thread_pool.h>
+#include <stdatomic.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+/* boards counted between checks of shared count, small enough to stop soon after max_count is reached */
+constexpr size_t COLOR_SCAN_CHUNK_SIZE = 4096u;
+/* smaller scans are not worth starting a thread for */
+constexpr size_t COLOR_SCAN_MIN_BOARDS_PER_THREAD = 1u << 20;
+
+typedef size_t (*ColorScan_CountFunction_t)(const ColorScan_Table_t* const table, size_t first_board, size_t boards_count);
+
+typedef struct
+{
+    const ColorScan_Table_t* table;
+    ColorScan_CountFunction_t count;
+    size_t first_board;
+    size_t boards_count;
+    size_t max_count;
+    atomic_size_t* total_count; /* shared by all jobs */
+} ColorScan_Job_t;
+
+static void* ColorScan_Worker(void* arg);
+static ColorScan_CountFunction_t ColorScan_GetCountFunction(void);
+#if defined(__x86_64__)
+__attribute__((target("ssse3"))) static size_t ColorScan_CountSsse3(const ColorScan_Table_t* const table, size_t first_board, size_t boards_count);
+__attribute__((target("avx2"))) static size_t ColorScan_CountAvx2(const ColorScan_Table_t* const table, size_t first_board, size_t boards_count);
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+static size_t ColorScan_CountNeon(const ColorScan_Table_t* const table, size_t first_board, size_t boards_count);
+#endif
+
+void ColorScan_SetColor(ColorScan_Table_t* table, const uint8 column, const uint8 row, const uint8 color)
+{
+    if (color <= 8u)
+    {
+        table->lower_colors[column][row] = (uint8)(1u << (color - 1u));
+        table->higher_colors[column][row] = 0u;
+    }
+    else
+    {
+        table->lower_colors[column][row] = 0u;
+        table->higher_colors[column][row] = (uint8)(1u << (color - 9u));
+    }
+}
+
+size_t ColorScan_Count(const ColorScan_Table_t* const table, size_t first_board, size_t boards_count)
+{
+    return ColorScan_GetCountFunction()(table, first_board, boards_count);
+}
+
+size_t ColorScan_CountScalar(const ColorScan_Table_t* const table, size_t first_board, size_t boards_count)
+{
+    size_t count = 0u;
+
+    for (size_t board_idx = first_board; board_idx < first_board + boards_count; board_idx++)
+    {
+        uint8 lower_colors = 0u;
+        uint8 higher_colors = 0u;
+
+        for (uint8 column = 0u; column < table->columns_count; column++)
+        {
+            const uint8 row = table->columns[column][board_idx];
+            lower_colors |= table->lower_colors[column][row];
+            higher_colors |= table->higher_colors[column][row];
+        }
+
+        /* as many queens as colors, all of them covered means no color repeats */
+        count += ((lower_colors == table->lower_all_colors) && (higher_colors == table->higher_all_colors)) ? 1u : 0u;
+    }
+
+    return count;
+}
+
+size_t ColorScan_CountParallel(const ColorScan_Table_t* const table, size_t boards_count, size_t max_count, uint8 threads_count)
+{
+    threads_count = ThreadPool_GetThreadsCount(threads_count, boards_count / COLOR_SCAN_MIN_BOARDS_PER_THREAD);
+
+    atomic_size_t total_count;
+    atomic_init(&total_count, 0u);
+
+    const size_t boards_per_thread = (boards_count + threads_count - 1u) / threads_count;
+    const ColorScan_CountFunction_t count = ColorScan_GetCountFunction();
+
+    ColorScan_Job_t jobs[THREAD_POOL_MAX_THREADS];
+    uint8 jobs_count = 0u;
+
+    for (size_t first_board = 0u; first_board < boards_count; first_board += boards_per_thread)
+    {
+        jobs[jobs_count] = (ColorScan_Job_t){
+            .table = table,
+            .count = count,
+            .first_board = first_board,
+            .boards_count = ((boards_count - first_board) < boards_per_thread) ? (boards_count - first_board) : boards_per_thread,
+            .max_count = max_count,
+            .total_count = &total_count
+        };
+        jobs_count++;
+    }
+
+    ThreadPool_Run(ColorScan_Worker, jobs, sizeof(ColorScan_Job_t), jobs_count);
+
+    const size_t final_count = atomic_load(&total_count);
+
+    return (final_count < max_count) ? final_count : max_count;
+}
+
+const char* ColorScan_GetImplementation(void)
+{
+#if defined(__x86_64__)
+    return __builtin_cpu_supports("avx2") ? "avx2" : (__builtin_cpu_supports("ssse3") ? "ssse3" : "scalar");
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+static void* ColorScan_Worker(void* arg)
+{
+    ColorScan_Job_t* job = arg;
+
+    for (size_t first_board = job->first_board; first_board < job->first_board + job->boards_count; first_board += COLOR_SCAN_CHUNK_SIZE)
+    {
+        /* other thread may have reached max_count already */
+        if (atomic_load_explicit(job->total_count, memory_order_relaxed) >= job->max_count)
+        {
+            break;
+        }
+
+        const size_t remaining_count = job->first_board + job->boards_count - first_board;
+        const size_t chunk_count = job->count(job->table, first_board, (remaining_count < COLOR_SCAN_CHUNK_SIZE) ? remaining_count : COLOR_SCAN_CHUNK_SIZE);
+
+        if (chunk_count > 0u)
+        {
+            (void)atomic_fetch_add_explicit(job->total_count, chunk_count, memory_order_relaxed);
+        }
+    }
+
+    return NULL;
+}
+
+static ColorScan_CountFunction_t ColorScan_GetCountFunction(void)
+{
+#if defined(__x86_64__)
+    /* shuffle needs SSSE3, which is not part of x86-64 baseline */
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return ColorScan_CountAvx2;
+    }
+
+    return __builtin_cpu_supports("ssse3") ? ColorScan_CountSsse3 : ColorScan_CountScalar;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    return ColorScan_CountNeon;
+#else
+    return ColorScan_CountScalar;
+#endif
+}
+
+#if defined(__x86_64__)
+__attribute__((target("ssse3"))) static size_t ColorScan_CountSsse3(const ColorScan_Table_t* const table, size_t first_board, size_t boards_count)
+{
+    const __m128i lower_all_colors = _mm_set1_epi8((char)table->lower_all_colors);
+    const __m128i higher_all_colors = _mm_set1_epi8((char)table->higher_all_colors);
+    const size_t tail_count = boards_count % 16u;
+    const size_t end_board = first_board + boards_count - tail_count;
+    size_t count = 0u;
+
+    for (size_t board_idx = first_board; board_idx < end_board; board_idx += 16u)
+    {
+        __m128i lower_colors = _mm_setzero_si128();
+        __m128i higher_colors = _mm_setzero_si128();
+
+        /* rows of 16 boards are indexes into color tables of the column */
+        for (uint8 column = 0u; column < table->columns_count; column++)
+        {
+            const __m128i rows = _mm_loadu_si128((const __m128i*)&table->columns[column][board_idx]);
+            lower_colors = _mm_or_si128(lower_colors, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)table->lower_colors[column]), rows));
+            higher_colors = _mm_or_si128(higher_colors, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)table->higher_colors[column]), rows));
+        }
+
+        const __m128i all_colors = _mm_and_si128(_mm_cmpeq_epi8(lower_colors, lower_all_colors), _mm_cmpeq_epi8(higher_colors, higher_all_colors));
+        count += (size_t)__builtin_popcount((unsigned int)_mm_movemask_epi8(all_colors));
+    }
+
+    return count + ColorScan_CountScalar(table, end_board, tail_count);
+}
+
+__attribute__((target("avx2"))) static size_t ColorScan_CountAvx2(const ColorScan_Table_t* const table, size_t first_board, size_t boards_count)
+{
+    const __m256i lower_all_colors = _mm256_set1_epi8((char)table->lower_all_colors);
+    const __m256i higher_all_colors = _mm256_set1_epi8((char)table->higher_all_colors);
+    const size_t tail_count = boards_count % 32u;
+    const size_t end_board = first_board + boards_count - tail_count;
+    size_t count = 0u;
+
+    for (size_t board_idx = first_board; board_idx < end_board; board_idx += 32u)
+    {
+        __m256i lower_colors = _mm256_setzero_si256();
+        __m256i higher_colors = _mm256_setzero_si256();
+
+        /* shuffle works within 128-bit lanes, color tables are repeated in both of them */
+        for (uint8 column = 0u; column < table->columns_count; column++)
+        {
+            const __m256i rows = _mm256_loadu_si256((const __m256i*)&table->columns[column][board_idx]);
+            const __m256i lower_table = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)table->lower_colors[column]));
+            const __m256i higher_table = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)table->higher_colors[column]));
+            lower_colors = _mm256_or_si256(lower_colors, _mm256_shuffle_epi8(lower_table, rows));
+            higher_colors = _mm256_or_si256(higher_colors, _mm256_shuffle_epi8(higher_table, rows));
+        }
+
+        const __m256i all_colors = _mm256_and_si256(_mm256_cmpeq_epi8(lower_colors, lower_all_colors), _mm256_cmpeq_epi8(higher_colors, higher_all_colors));
+        count += (size_t)__builtin_popcount((unsigned int)_mm256_movemask_epi8(all_colors));
+    }
+
+    return count + ColorScan_CountSsse3(table, end_board, tail_count);
+}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+static size_t ColorScan_CountNeon(const ColorScan_Table_t* const table, size_t first_board, size_t boards_count)
+{
+    const uint8x16_t lower_all_colors = vdupq_n_u8(table->lower_all_colors);
+    const uint8x16_t higher_all_colors = vdupq_n_u8(table->higher_all_colors);
+    const uint8x16_t one = vdupq_n_u8(1u);
+    const size_t tail_count = boards_count % 16u;
+    const size_t end_board = first_board + boards_count - tail_count;
+    size_t count = 0u;
+
+    for (size_t board_idx = first_board; board_idx < end_board; board_idx += 16u)
+    {
+        uint8x16_t lower_colors = vdupq_n_u8(0u);
+        uint8x16_t higher_colors = vdupq_n_u8(0u);
+
+        for (uint8 column = 0u; column < table->columns_count; column++)
+        {
+            const uint8x16_t rows = vld1q_u8(&table->columns[column][board_idx]);
+            lower_colors = vorrq_u8(lower_colors, vqtbl1q_u8(vld1q_u8(table->lower_colors[column]), rows));
+            higher_colors = vorrq_u8(higher_colors, vqtbl1q_u8(vld1q_u8(table->higher_colors[column]), rows));
+        }
+
+        const uint8x16_t all_colors = vandq_u8(vceqq_u8(lower_colors, lower_all_colors), vceqq_u8(higher_colors, higher_all_colors));
+        count += vaddvq_u8(vandq_u8(all_colors, one));
+    }
+
+    return count + ColorScan_CountScalar(table, end_board, tail_count);
+}
+#endif
@@ -1,6 +1,8 @@
 #include <global_config.h>
 #include <rng.h>
 #include <arg_parser.h>
+#include <queens_boardgen.h>
+#include <stdlib.h>
 
 void global_config_init();
 
@@ -10,16 +12,41 @@ int main(int argc, char** argv)
     // RNG_Seed((uint64)4ULL);
     global_config_init();
 
+    /* long-running hosts get uniqueness backends decided and their data loaded before first request needs them */
+    if (global_config.permutations_warmup_sizes != 0u)
+    {
+        (void)QueensBoardGen_StartWarmUp(global_config.permutations_warmup_sizes);
+    }
+
     return ArgParser_ParseArguments(argc, argv);
 }
 
 void global_config_init()
 {
     global_config.debug_print_enabled = false;
+    global_config.permutations_cache_dir = getenv("QUEENS_CACHE_DIR");
     global_config.permutations_compressed = true;
+    global_config.permutations_symmetry_reduced = false;
+    global_config.permutations_prefix_tree = false;
+    global_config.permutations_checkpoint = true;
+    global_config.permutations_sharded = false;
+    global_config.permutations_mmap = true;
+    global_config.permutations_keep_packed = true;
+    global_config.permutations_generate_threads = 0u;
+    global_config.permutations_unpack_threads = 0u;
+    global_config.permutations_sample_from_counts = true;
+    global_config.permutations_table_max_size = (size_t)1024u * 1024u * 1024u;
+    global_config.permutations_registry_budget = (size_t)512u * 1024u * 1024u;
+    global_config.permutations_column_major = false;
+    global_config.permutations_warmup_sizes = 0u;
     global_config.boardgen_cell_skip_chance = 20u;
     global_config.boardgen_neighbor_skip_chance = 80u;
     global_config.boardgen_only_horizontal_neighbor_chance = 5u;
     global_config.boardgen_only_vertical_neighbor_chance = 5u;
+    global_config.boardgen_uniqueness_backend = 0u;
+    global_config.boardgen_incremental_check = true;
+    global_config.boardgen_bit_parallel_fill = true;
+    global_config.boardgen_repair = true;
+    global_config.boardgen_scan_threads = 0u;
     global_config.board_sparse_print = false;
 }
@@ -0,0 +1,219 @@
+#include <nibble.h>
+#include <constants.h>
+#include <thread_pool.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/* parallel unpacking splits bytes into chunks aligned to this, so that every thread runs whole vectors */
+constexpr size_t NIBBLE_PARALLEL_CHUNK_ALIGN = 64u;
+
+typedef void (*Nibble_UnpackBytesFunction_t)(uint8* dest, const uint8* src, size_t bytes_count);
+
+typedef struct
+{
+    uint8* dest;
+    const uint8* src;
+    size_t bytes_count;
+} Nibble_UnpackJob_t;
+
+static void Nibble_UnpackWith(Nibble_UnpackBytesFunction_t unpack_bytes, uint8* dest, const uint8* src, size_t first_nibble, size_t nibbles_count);
+static void* Nibble_UnpackWorker(void* arg);
+static Nibble_UnpackBytesFunction_t Nibble_GetUnpackBytesFunction(void);
+static void Nibble_UnpackBytesScalar(uint8* dest, const uint8* src, size_t bytes_count);
+#if defined(__x86_64__)
+static void Nibble_UnpackBytesSse2(uint8* dest, const uint8* src, size_t bytes_count);
+__attribute__((target("avx2"))) static void Nibble_UnpackBytesAvx2(uint8* dest, const uint8* src, size_t bytes_count);
+#elif defined(__ARM_NEON)
+static void Nibble_UnpackBytesNeon(uint8* dest, const uint8* src, size_t bytes_count);
+#endif
+
+void Nibble_Unpack(uint8* dest, const uint8* src, size_t first_nibble, size_t nibbles_count)
+{
+    Nibble_UnpackWith(Nibble_GetUnpackBytesFunction(), dest, src, first_nibble, nibbles_count);
+}
+
+void Nibble_UnpackScalar(uint8* dest, const uint8* src, size_t first_nibble, size_t nibbles_count)
+{
+    Nibble_UnpackWith(Nibble_UnpackBytesScalar, dest, src, first_nibble, nibbles_count);
+}
+
+void Nibble_UnpackParallel(uint8* dest, const uint8* src, size_t first_nibble, size_t nibbles_count, uint8 threads_count)
+{
+    /* board starting in the middle of a byte, after it everything is byte aligned */
+    if (((first_nibble % 2u) != 0u) &&
+        (nibbles_count > 0u))
+    {
+        dest[0] = (uint8)(src[first_nibble / 2u] & 0x0F);
+        dest++;
+        first_nibble++;
+        nibbles_count--;
+    }
+
+    src = &src[first_nibble / 2u];
+    const size_t bytes_count = nibbles_count / 2u;
+
+    if ((nibbles_count % 2u) != 0u)
+    {
+        dest[2u * bytes_count] = (uint8)(src[bytes_count] >> NIBBLE_LEN);
+    }
+
+    threads_count = ThreadPool_GetThreadsCount(threads_count, (bytes_count + NIBBLE_PARALLEL_CHUNK_ALIGN - 1u) / NIBBLE_PARALLEL_CHUNK_ALIGN);
+
+    size_t chunk_size = (bytes_count + threads_count - 1u) / threads_count;
+    chunk_size = ((chunk_size + NIBBLE_PARALLEL_CHUNK_ALIGN - 1u) / NIBBLE_PARALLEL_CHUNK_ALIGN) * NIBBLE_PARALLEL_CHUNK_ALIGN;
+
+    Nibble_UnpackJob_t jobs[THREAD_POOL_MAX_THREADS];
+    uint8 jobs_count = 0u;
+
+    for (size_t first_byte = 0u; first_byte < bytes_count; first_byte += chunk_size)
+    {
+        jobs[jobs_count].dest = &dest[2u * first_byte];
+        jobs[jobs_count].src = &src[first_byte];
+        jobs[jobs_count].bytes_count = ((bytes_count - first_byte) < chunk_size) ? (bytes_count - first_byte) : chunk_size;
+        jobs_count++;
+    }
+
+    ThreadPool_Run(Nibble_UnpackWorker, jobs, sizeof(Nibble_UnpackJob_t), jobs_count);
+}
+
+const char* Nibble_GetUnpackImplementation(void)
+{
+#if defined(__x86_64__)
+    return __builtin_cpu_supports("avx2") ? "avx2" : "sse2";
+#elif defined(__ARM_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+static void Nibble_UnpackWith(Nibble_UnpackBytesFunction_t unpack_bytes, uint8* dest, const uint8* src, size_t first_nibble, size_t nibbles_count)
+{
+    /* board starting in the middle of a byte (odd board sizes), only possible if dest and src don't overlap */
+    if (((first_nibble % 2u) != 0u) &&
+        (nibbles_count > 0u))
+    {
+        dest[0] = (uint8)(src[first_nibble / 2u] & 0x0F);
+        dest++;
+        first_nibble++;
+        nibbles_count--;
+    }
+
+    src = &src[first_nibble / 2u];
+    const size_t bytes_count = nibbles_count / 2u;
+
+    /* trailing nibble lies furthest in dest, it goes first so that in-place expansion doesn't overwrite anything unread */
+    if ((nibbles_count % 2u) != 0u)
+    {
+        dest[2u * bytes_count] = (uint8)(src[bytes_count] >> NIBBLE_LEN);
+    }
+
+    unpack_bytes(dest, src, bytes_count);
+}
+
+static void* Nibble_UnpackWorker(void* arg)
+{
+    Nibble_UnpackJob_t* job = arg;
+    Nibble_GetUnpackBytesFunction()(job->dest, job->src, job->bytes_count);
+
+    return NULL;
+}
+
+static Nibble_UnpackBytesFunction_t Nibble_GetUnpackBytesFunction(void)
+{
+#if defined(__x86_64__)
+    /* SSE2 is part of x86-64 baseline, AVX2 is checked at runtime as the build doesn't enable it */
+    return __builtin_cpu_supports("avx2") ? Nibble_UnpackBytesAvx2 : Nibble_UnpackBytesSse2;
+#elif defined(__ARM_NEON)
+    return Nibble_UnpackBytesNeon;
+#else
+    return Nibble_UnpackBytesScalar;
+#endif
+}
+
+/*
+    all variants go from the end: byte N is unpacked to bytes 2N and 2N+1, so going backwards never overwrites
+    packed bytes that are still to be read when dest and src are the same buffer
+*/
+static void Nibble_UnpackBytesScalar(uint8* dest, const uint8* src, size_t bytes_count)
+{
+    for (size_t byte_idx = bytes_count; byte_idx-- > 0u;)
+    {
+        const uint8 packed_byte = src[byte_idx];
+        dest[2u * byte_idx] = (uint8)(packed_byte >> NIBBLE_LEN);
+        dest[2u * byte_idx + 1u] = (uint8)(packed_byte & 0x0F);
+    }
+}
+
+#if defined(__x86_64__)
+static void Nibble_UnpackBytesSse2(uint8* dest, const uint8* src, size_t bytes_count)
+{
+    const __m128i lower_nibble_mask = _mm_set1_epi8(0x0F);
+    const size_t tail_bytes_count = bytes_count % 16u;
+    size_t byte_idx = bytes_count - tail_bytes_count;
+
+    Nibble_UnpackBytesScalar(&dest[2u * byte_idx], &src[byte_idx], tail_bytes_count);
+
+    while (byte_idx > 0u)
+    {
+        byte_idx -= 16u;
+
+        /* 16 packed bytes -> 32 rows, interleaving higher and lower nibbles keeps the order */
+        const __m128i packed = _mm_loadu_si128((const __m128i*)&src[byte_idx]);
+        const __m128i higher_nibbles = _mm_and_si128(_mm_srli_epi16(packed, NIBBLE_LEN), lower_nibble_mask);
+        const __m128i lower_nibbles = _mm_and_si128(packed, lower_nibble_mask);
+
+        _mm_storeu_si128((__m128i*)&dest[2u * byte_idx], _mm_unpacklo_epi8(higher_nibbles, lower_nibbles));
+        _mm_storeu_si128((__m128i*)&dest[2u * byte_idx + 16u], _mm_unpackhi_epi8(higher_nibbles, lower_nibbles));
+    }
+}
+
+__attribute__((target("avx2"))) static void Nibble_UnpackBytesAvx2(uint8* dest, const uint8* src, size_t bytes_count)
+{
+    const __m256i lower_nibble_mask = _mm256_set1_epi8(0x0F);
+    const size_t tail_bytes_count = bytes_count % 32u;
+    size_t byte_idx = bytes_count - tail_bytes_count;
+
+    Nibble_UnpackBytesSse2(&dest[2u * byte_idx], &src[byte_idx], tail_bytes_count);
+
+    while (byte_idx > 0u)
+    {
+        byte_idx -= 32u;
+
+        const __m256i packed = _mm256_loadu_si256((const __m256i*)&src[byte_idx]);
+        const __m256i higher_nibbles = _mm256_and_si256(_mm256_srli_epi16(packed, NIBBLE_LEN), lower_nibble_mask);
+        const __m256i lower_nibbles = _mm256_and_si256(packed, lower_nibble_mask);
+
+        /* unpack works within 128-bit lanes: bytes 0-7 | 16-23 and 8-15 | 24-31, lanes are put back in order */
+        const __m256i interleaved_low = _mm256_unpacklo_epi8(higher_nibbles, lower_nibbles);
+        const __m256i interleaved_high = _mm256_unpackhi_epi8(higher_nibbles, lower_nibbles);
+
+        _mm256_storeu_si256((__m256i*)&dest[2u * byte_idx], _mm256_permute2x128_si256(interleaved_low, interleaved_high, 0x20));
+        _mm256_storeu_si256((__m256i*)&dest[2u * byte_idx + 32u], _mm256_permute2x128_si256(interleaved_low, interleaved_high, 0x31));
+    }
+}
+#elif defined(__ARM_NEON)
+static void Nibble_UnpackBytesNeon(uint8* dest, const uint8* src, size_t bytes_count)
+{
+    const uint8x16_t lower_nibble_mask = vdupq_n_u8(0x0F);
+    const size_t tail_bytes_count = bytes_count % 16u;
+    size_t byte_idx = bytes_count - tail_bytes_count;
+
+    Nibble_UnpackBytesScalar(&dest[2u * byte_idx], &src[byte_idx], tail_bytes_count);
+
+    while (byte_idx > 0u)
+    {
+        byte_idx -= 16u;
+
+        /* interleaving store writes higher and lower nibble of every byte next to each other */
+        const uint8x16_t packed = vld1q_u8(&src[byte_idx]);
+        const uint8x16x2_t unpacked = { { vshrq_n_u8(packed, NIBBLE_LEN), vandq_u8(packed, lower_nibble_mask) } };
+
+        vst2q_u8(&dest[2u * byte_idx], unpacked);
+    }
+}
+#endif
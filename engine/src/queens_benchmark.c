@@ -0,0 +1,691 @@
+#include <queens_benchmark.h>
+#include <queens_permutations.h>
+#include <queens_permutations_registry.h>
+#include <queens_permutations_index.h>
+#include <queens_boardgen.h>
+#include <constants.h>
+#include <color_scan.h>
+#include <global_config.h>
+#include <nibble.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static int QueensBenchmark_PermutationsGenerate(int argc, char **argv);
+static int QueensBenchmark_NibbleUnpack(int argc, char **argv);
+static double QueensBenchmark_MeasureNibbleUnpack(uint8* dest, const uint8* src, size_t nibbles_count, long threads);
+static int QueensBenchmark_TimeToPuzzle(int argc, char **argv);
+static int QueensBenchmark_UniquenessBackend(int argc, char **argv);
+static int QueensBenchmark_ColumnScan(int argc, char **argv);
+static int QueensBenchmark_Repair(int argc, char **argv);
+static int QueensBenchmark_RegionGrowth(int argc, char **argv);
+static double QueensBenchmark_MeasurePuzzleRate(QueensBoard_Board_t* board, const double time_limit);
+static double QueensBenchmark_GetTimeSeconds(void);
+static bool QueensBenchmark_ParseBoardSize(const char* arg, uint8* board_size);
+
+static const QueensBenchmark_Benchmark_t benchmarks[] = {
+    {"permutations_generate", QueensBenchmark_PermutationsGenerate, "Permutations generation time per thread count", "<board_size> [<max_threads>]"},
+    {"nibble_unpack",         QueensBenchmark_NibbleUnpack,         "Packed permutations table unpacking throughput, scalar vs SIMD vs threads", "<board_size> [<max_threads>]"},
+    {"time_to_puzzle",        QueensBenchmark_TimeToPuzzle,         "Time to generate board with exactly one solution, per board size", "[<puzzles_per_size>] [<seconds_per_size>] [<min_board_size>] [<max_board_size>]"},
+    {"uniqueness_backend",    QueensBenchmark_UniquenessBackend,    "Uniqueness check backend picked per board size and its validation time", "[<boards_per_size>] [<min_board_size>] [<max_board_size>]"},
+    {"column_scan",           QueensBenchmark_ColumnScan,           "Validation against full table, row-major scalar vs column-major SIMD vs threads", "[<boards_per_size>] [<min_board_size>] [<max_board_size>] [<threads>]"},
+    {"repair",                QueensBenchmark_Repair,               "Accepted puzzles per second with boards failing validation regenerated vs repaired", "[<seconds_per_size>] [<min_board_size>] [<max_board_size>]"},
+    {"region_growth",         QueensBenchmark_RegionGrowth,         "Board fill time and region statistics, cell by cell vs bit-parallel region growth", "[<boards_per_size>] [<min_board_size>] [<max_board_size>]"},
+};
+
+int QueensBenchmark_Run(const char* name, int argc, char **argv)
+{
+    for (uint8 i = 0; i < sizeof(benchmarks)/sizeof(QueensBenchmark_Benchmark_t); i++)
+    {
+        if (strcmp(name, benchmarks[i].name) == 0)
+        {
+            return benchmarks[i].function(argc, argv);
+        }
+    }
+
+    printf("Unknown benchmark \"%s\"\n", name);
+    QueensBenchmark_PrintList();
+
+    return 1;
+}
+
+void QueensBenchmark_PrintList(void)
+{
+    printf("Benchmarks:\n");
+    for (uint8 i = 0; i < sizeof(benchmarks)/sizeof(QueensBenchmark_Benchmark_t); i++)
+    {
+        printf("  %s - %s. Args: %s\n", benchmarks[i].name, benchmarks[i].description, benchmarks[i].args);
+    }
+}
+
+static int QueensBenchmark_PermutationsGenerate(int argc, char **argv)
+{
+    uint8 board_size = 0u;
+    if ((argc < 1) || (QueensBenchmark_ParseBoardSize(argv[0], &board_size) == false))
+    {
+        printf("Expected board size between %d and %d\n", QUEENS_MIN_BOARD_SIZE, QUEENS_MAX_BOARD_SIZE);
+        return 1;
+    }
+
+    long max_threads = (argc >= 2) ? atol(argv[1]) : sysconf(_SC_NPROCESSORS_ONLN);
+    if (max_threads < 1)
+    {
+        max_threads = 1;
+    }
+
+    if (max_threads > board_size)
+    {
+        max_threads = board_size;
+    }
+
+    QueensPermutations_Result_t reference = { 0 };
+    double reference_time = 0.0;
+
+    printf("threads;time_s;speedup;boards;identical\n");
+
+    /* 1, 2, 4, ... threads, always finishing with max_threads */
+    long threads = 1;
+    for (;;)
+    {
+        double start_time = QueensBenchmark_GetTimeSeconds();
+        QueensPermutations_Result_t result = QueensPermutations_Generate(board_size, (uint8)threads);
+        double elapsed_time = QueensBenchmark_GetTimeSeconds() - start_time;
+
+        if (result.success == false)
+        {
+            printf("Generation failed!\n");
+            return 1;
+        }
+
+        bool identical = true;
+        if (threads == 1)
+        {
+            reference = result;
+            reference_time = elapsed_time;
+        }
+        else
+        {
+            identical = (result.boards_count == reference.boards_count) &&
+                        (memcmp(result.boards, reference.boards, (size_t)result.boards_count * board_size) == 0);
+        }
+
+        printf("%ld;%.3f;%.2f;%llu;%s\n", threads, elapsed_time, reference_time / elapsed_time, (unsigned long long)result.boards_count, identical ? "yes" : "NO");
+
+        if (threads != 1)
+        {
+            (void)QueensPermutations_FreeResult(&result);
+        }
+
+        if (threads == max_threads)
+        {
+            break;
+        }
+
+        threads = ((threads * 2) > max_threads) ? max_threads : (threads * 2);
+    }
+
+    (void)QueensPermutations_FreeResult(&reference);
+
+    return 0;
+}
+
+static int QueensBenchmark_NibbleUnpack(int argc, char **argv)
+{
+    uint8 board_size = 0u;
+    if ((argc < 1) || (QueensBenchmark_ParseBoardSize(argv[0], &board_size) == false))
+    {
+        printf("Expected board size between %d and %d\n", QUEENS_MIN_BOARD_SIZE, QUEENS_MAX_BOARD_SIZE);
+        return 1;
+    }
+
+    long max_threads = (argc >= 2) ? atol(argv[1]) : sysconf(_SC_NPROCESSORS_ONLN);
+    if (max_threads < 1)
+    {
+        max_threads = 1;
+    }
+
+    if (max_threads > UINT8_MAX)
+    {
+        max_threads = UINT8_MAX;
+    }
+
+    QueensPermutations_Result_t permutations = QueensPermutations_Generate(board_size, 0u);
+    if (permutations.success == false)
+    {
+        printf("Generation failed!\n");
+        return 1;
+    }
+
+    /* same layout as nibble encoded permutations file payload */
+    const size_t nibbles_count = (size_t)permutations.boards_count * board_size;
+    const uint8* reference = (const uint8*)permutations.boards;
+    uint8* packed = calloc((nibbles_count + 1u) / 2u, 1u);
+    uint8* unpacked = malloc(nibbles_count);
+
+    if ((packed == NULL) || (unpacked == NULL))
+    {
+        printf("Allocation failed!\n");
+        free(packed);
+        free(unpacked);
+        (void)QueensPermutations_FreeResult(&permutations);
+        return 1;
+    }
+
+    for (size_t nibble_idx = 0u; nibble_idx < nibbles_count; nibble_idx++)
+    {
+        packed[nibble_idx / 2u] |= (uint8)(((nibble_idx % 2u) == 0u) ? (reference[nibble_idx] << 4u) : reference[nibble_idx]);
+    }
+
+    printf("SIMD implementation: %s, unpacked size: %zu bytes\n", Nibble_GetUnpackImplementation(), nibbles_count);
+    printf("implementation;threads;time_s;gb_per_s;speedup;identical\n");
+
+    /* threads 0 - plain scalar loop, -1 - single threaded SIMD, then parallel SIMD on 1, 2, 4, ... threads */
+    double scalar_time = 0.0;
+    long threads = 0;
+    for (;;)
+    {
+        memset(unpacked, 0xFF, nibbles_count);
+        const double elapsed_time = QueensBenchmark_MeasureNibbleUnpack(unpacked, packed, nibbles_count, threads);
+        const bool identical = (memcmp(unpacked, reference, nibbles_count) == 0);
+
+        if (threads == 0)
+        {
+            scalar_time = elapsed_time;
+        }
+
+        printf("%s;%ld;%.6f;%.2f;%.2f;%s\n",
+               (threads == 0) ? "scalar" : ((threads < 0) ? "simd" : "simd_parallel"),
+               (threads < 1) ? 1 : threads,
+               elapsed_time,
+               (double)nibbles_count / elapsed_time / 1e9,
+               scalar_time / elapsed_time,
+               identical ? "yes" : "NO");
+
+        if (threads == max_threads)
+        {
+            break;
+        }
+
+        if (threads < 1)
+        {
+            threads = (threads == 0) ? -1 : 1;
+        }
+        else
+        {
+            threads = ((threads * 2) > max_threads) ? max_threads : (threads * 2);
+        }
+    }
+
+    free(packed);
+    free(unpacked);
+    (void)QueensPermutations_FreeResult(&permutations);
+
+    return 0;
+}
+
+/* average time of single unpack, repeated for at least half a second to get stable figure for small tables */
+static double QueensBenchmark_MeasureNibbleUnpack(uint8* dest, const uint8* src, size_t nibbles_count, long threads)
+{
+    const double min_measurement_time = 0.5;
+
+    uint32 repetitions = 0u;
+    double elapsed_time = 0.0;
+    const double start_time = QueensBenchmark_GetTimeSeconds();
+
+    do
+    {
+        if (threads == 0)
+        {
+            Nibble_UnpackScalar(dest, src, 0u, nibbles_count);
+        }
+        else if (threads < 0)
+        {
+            Nibble_Unpack(dest, src, 0u, nibbles_count);
+        }
+        else
+        {
+            Nibble_UnpackParallel(dest, src, 0u, nibbles_count, (uint8)threads);
+        }
+
+        repetitions++;
+        elapsed_time = QueensBenchmark_GetTimeSeconds() - start_time;
+    } while (elapsed_time < min_measurement_time);
+
+    return elapsed_time / repetitions;
+}
+
+static int QueensBenchmark_TimeToPuzzle(int argc, char **argv)
+{
+    /* board is regenerated in slices of this many iterations, time limit is checked between them */
+    const uint32 iterations_slice = 32u;
+
+    long puzzles_count = (argc >= 1) ? atol(argv[0]) : 3;
+    double size_time_limit = (argc >= 2) ? atof(argv[1]) : 60.0;
+    uint8 min_board_size = QUEENS_MIN_BOARD_SIZE;
+    uint8 max_board_size = QUEENS_MAX_BOARD_SIZE;
+
+    if ((puzzles_count < 1) ||
+        (size_time_limit <= 0.0) ||
+        ((argc >= 3) && (QueensBenchmark_ParseBoardSize(argv[2], &min_board_size) == false)) ||
+        ((argc >= 4) && (QueensBenchmark_ParseBoardSize(argv[3], &max_board_size) == false)))
+    {
+        printf("Expected positive number of puzzles and time limit, board sizes between %d and %d\n", QUEENS_MIN_BOARD_SIZE, QUEENS_MAX_BOARD_SIZE);
+        return 1;
+    }
+
+    printf("board_size;permutations;backend;puzzles;first_s;avg_s;avg_iterations;time_s\n");
+
+    for (uint8 board_size = min_board_size; board_size <= max_board_size; board_size++)
+    {
+        QueensBoard_Board_t board = { 0 };
+        if (QueensBoard_Create(&board, board_size) == false)
+        {
+            printf("Allocation failed!\n");
+            return 1;
+        }
+
+        /* first puzzle includes loading (or generating) whatever the size needs, later ones show steady state */
+        const double start_time = QueensBenchmark_GetTimeSeconds();
+        double first_time = 0.0;
+        double elapsed_time = 0.0;
+        uint64 total_iterations = 0u;
+        long found_count = 0;
+
+        while ((found_count < puzzles_count) &&
+               (elapsed_time < size_time_limit))
+        {
+            uint32 iterations = 0u;
+            QueensBoardGen_Result_t result = QueensBoardGen_GenerateUnique(&board, iterations_slice, &iterations);
+            elapsed_time = QueensBenchmark_GetTimeSeconds() - start_time;
+            total_iterations += iterations;
+
+            if (result == QUEENS_BOARDGEN_ERROR)
+            {
+                printf("Generation failed for board size %u!\n", board_size);
+                return 1;
+            }
+
+            if (result == QUEENS_BOARDGEN_SUCCESS)
+            {
+                first_time = (found_count == 0) ? elapsed_time : first_time;
+                found_count++;
+            }
+        }
+
+        /* sizes without any puzzle within the limit report time and iterations spent in vain */
+        const long divisor = (found_count > 0) ? found_count : 1;
+
+        printf("%u;%llu;%s;%ld;%.3f;%.3f;%.1f;%.3f\n",
+               board_size,
+               (unsigned long long)QueensPermutations_GetCount(board_size),
+               QueensBoardGen_GetBackendName(QueensBoardGen_GetBackend(board_size)),
+               found_count,
+               first_time,
+               elapsed_time / (double)divisor,
+               (double)total_iterations / (double)divisor,
+               elapsed_time);
+
+        QueensBoard_Free(&board);
+    }
+
+    /* tables of all sizes stay loaded otherwise */
+    QueensPermutationsRegistry_Clear();
+
+    return 0;
+}
+
+static int QueensBenchmark_UniquenessBackend(int argc, char **argv)
+{
+    long boards_count = (argc >= 1) ? atol(argv[0]) : 100;
+    uint8 min_board_size = QUEENS_MIN_BOARD_SIZE;
+    uint8 max_board_size = QUEENS_MAX_BOARD_SIZE;
+
+    if ((boards_count < 1) ||
+        ((argc >= 2) && (QueensBenchmark_ParseBoardSize(argv[1], &min_board_size) == false)) ||
+        ((argc >= 3) && (QueensBenchmark_ParseBoardSize(argv[2], &max_board_size) == false)))
+    {
+        printf("Expected positive number of boards, board sizes between %d and %d\n", QUEENS_MIN_BOARD_SIZE, QUEENS_MAX_BOARD_SIZE);
+        return 1;
+    }
+
+    printf("board_size;backend;table_bytes;table_scan_us;index_bytes;index_us;search_us;memo_us;validate_us\n");
+
+    for (uint8 board_size = min_board_size; board_size <= max_board_size; board_size++)
+    {
+        QueensBoard_Board_t board = { 0 };
+        if (QueensBoard_Create(&board, board_size) == false)
+        {
+            printf("Allocation failed!\n");
+            return 1;
+        }
+
+        /* first validations measure the search, backend is decided after them. Next one loads whatever the backend needs */
+        do
+        {
+            if (QueensBoardGen_Generate(&board, NULL) != QUEENS_BOARDGEN_SUCCESS)
+            {
+                printf("Generation failed for board size %u!\n", board_size);
+                return 1;
+            }
+
+            (void)QueensBoardGen_ValidateOnlyOneSolution(&board, NULL);
+        } while (QueensBoardGen_GetBackendStats(board_size).backend == QUEENS_BOARDGEN_BACKEND_AUTO);
+
+        (void)QueensBoardGen_ValidateOnlyOneSolution(&board, NULL);
+
+        /* only validation is timed, generation is not */
+        double validate_time = 0.0;
+        for (long board_idx = 0; board_idx < boards_count; board_idx++)
+        {
+            (void)QueensBoardGen_Generate(&board, NULL);
+
+            const double start_time = QueensBenchmark_GetTimeSeconds();
+            (void)QueensBoardGen_ValidateOnlyOneSolution(&board, NULL);
+            validate_time += QueensBenchmark_GetTimeSeconds() - start_time;
+        }
+
+        const QueensBoardGen_BackendStats_t stats = QueensBoardGen_GetBackendStats(board_size);
+
+        printf("%u;%s;%llu;%.1f;%llu;%.1f;%.1f;%.1f;%.1f\n",
+               board_size,
+               QueensBoardGen_GetBackendName(stats.backend),
+               (unsigned long long)stats.table_size,
+               stats.table_scan_time * 1e6,
+               (unsigned long long)stats.index_size,
+               stats.index_time * 1e6,
+               stats.search_time * 1e6,
+               stats.memo_time * 1e6,
+               validate_time * 1e6 / (double)boards_count);
+
+        QueensBoard_Free(&board);
+    }
+
+    QueensPermutationsRegistry_Clear();
+    QueensPermutationsIndex_Clear();
+
+    return 0;
+}
+
+static int QueensBenchmark_ColumnScan(int argc, char **argv)
+{
+    long boards_count = (argc >= 1) ? atol(argv[0]) : 100;
+    uint8 min_board_size = 8u;
+    uint8 max_board_size = 12u;
+    long threads = (argc >= 4) ? atol(argv[3]) : sysconf(_SC_NPROCESSORS_ONLN);
+
+    if ((boards_count < 1) ||
+        ((argc >= 2) && (QueensBenchmark_ParseBoardSize(argv[1], &min_board_size) == false)) ||
+        ((argc >= 3) && (QueensBenchmark_ParseBoardSize(argv[2], &max_board_size) == false)) ||
+        (threads < 1) || (threads > UINT8_MAX))
+    {
+        printf("Expected positive number of boards, board sizes between %d and %d, 1 to %d threads\n", QUEENS_MIN_BOARD_SIZE, QUEENS_MAX_BOARD_SIZE, UINT8_MAX);
+        return 1;
+    }
+
+    const uint8 scan_threads = global_config.boardgen_scan_threads;
+
+    printf("SIMD implementation: %s\n", ColorScan_GetImplementation());
+    printf("board_size;permutations;row_major_us;column_major_us;column_major_parallel_us;threads;speedup;mismatches\n");
+
+    for (uint8 board_size = min_board_size; board_size <= max_board_size; board_size++)
+    {
+        QueensPermutations_Result_t permutations = QueensPermutations_Generate(board_size, 0u);
+        QueensPermutations_Result_t columns = QueensPermutations_ToColumnMajor(&permutations);
+        QueensBoard_Board_t board = { 0 };
+
+        if ((permutations.success == false) ||
+            (columns.success == false) ||
+            (QueensBoard_Create(&board, board_size) == false))
+        {
+            printf("Generation failed for board size %u!\n", board_size);
+            (void)QueensPermutations_FreeResult(&permutations);
+            (void)QueensPermutations_FreeResult(&columns);
+            return 1;
+        }
+
+        /* same boards for every variant, only validation is timed */
+        double times[3] = { 0.0 };
+        uint32 mismatches_count = 0u;
+
+        for (long board_idx = 0; board_idx < boards_count; board_idx++)
+        {
+            (void)QueensBoardGen_Generate(&board, NULL);
+
+            double start_time = QueensBenchmark_GetTimeSeconds();
+            const bool row_major_unique = QueensBoardGen_ValidateOnlyOneSolution(&board, &permutations);
+            times[0] += QueensBenchmark_GetTimeSeconds() - start_time;
+
+            global_config.boardgen_scan_threads = 1u;
+            start_time = QueensBenchmark_GetTimeSeconds();
+            const bool column_major_unique = QueensBoardGen_ValidateOnlyOneSolution(&board, &columns);
+            times[1] += QueensBenchmark_GetTimeSeconds() - start_time;
+
+            global_config.boardgen_scan_threads = (uint8)threads;
+            start_time = QueensBenchmark_GetTimeSeconds();
+            const bool parallel_unique = QueensBoardGen_ValidateOnlyOneSolution(&board, &columns);
+            times[2] += QueensBenchmark_GetTimeSeconds() - start_time;
+
+            mismatches_count += ((row_major_unique != column_major_unique) || (row_major_unique != parallel_unique)) ? 1u : 0u;
+        }
+
+        printf("%u;%llu;%.1f;%.1f;%.1f;%ld;%.2f;%u\n",
+               board_size,
+               (unsigned long long)permutations.boards_count,
+               times[0] * 1e6 / (double)boards_count,
+               times[1] * 1e6 / (double)boards_count,
+               times[2] * 1e6 / (double)boards_count,
+               threads,
+               times[0] / times[2],
+               mismatches_count);
+
+        QueensBoard_Free(&board);
+        (void)QueensPermutations_FreeResult(&permutations);
+        (void)QueensPermutations_FreeResult(&columns);
+    }
+
+    global_config.boardgen_scan_threads = scan_threads;
+
+    return 0;
+}
+
+static int QueensBenchmark_Repair(int argc, char **argv)
+{
+    double size_time_limit = (argc >= 1) ? atof(argv[0]) : 10.0;
+    uint8 min_board_size = 7u;
+    uint8 max_board_size = 12u;
+
+    if ((size_time_limit <= 0.0) ||
+        ((argc >= 2) && (QueensBenchmark_ParseBoardSize(argv[1], &min_board_size) == false)) ||
+        ((argc >= 3) && (QueensBenchmark_ParseBoardSize(argv[2], &max_board_size) == false)))
+    {
+        printf("Expected positive time limit, board sizes between %d and %d\n", QUEENS_MIN_BOARD_SIZE, QUEENS_MAX_BOARD_SIZE);
+        return 1;
+    }
+
+    const bool repair = global_config.boardgen_repair;
+
+    printf("board_size;regenerate_puzzles_per_s;repair_puzzles_per_s;speedup\n");
+
+    for (uint8 board_size = min_board_size; board_size <= max_board_size; board_size++)
+    {
+        QueensBoard_Board_t board = { 0 };
+        if (QueensBoard_Create(&board, board_size) == false)
+        {
+            printf("Allocation failed!\n");
+            return 1;
+        }
+
+        /* half of the time each, with the same warmed up source and backend */
+        uint32 iterations = 0u;
+        (void)QueensBoardGen_GenerateUnique(&board, 1u, &iterations);
+
+        global_config.boardgen_repair = false;
+        const double regenerate_rate = QueensBenchmark_MeasurePuzzleRate(&board, size_time_limit / 2.0);
+
+        global_config.boardgen_repair = true;
+        const double repair_rate = QueensBenchmark_MeasurePuzzleRate(&board, size_time_limit / 2.0);
+
+        printf("%u;%.3f;%.3f;%.2f\n",
+               board_size,
+               regenerate_rate,
+               repair_rate,
+               (regenerate_rate > 0.0) ? (repair_rate / regenerate_rate) : 0.0);
+
+        QueensBoard_Free(&board);
+    }
+
+    global_config.boardgen_repair = repair;
+
+    return 0;
+}
+
+static int QueensBenchmark_RegionGrowth(int argc, char **argv)
+{
+    long boards_count = (argc >= 1) ? atol(argv[0]) : 1000;
+    uint8 min_board_size = QUEENS_MIN_BOARD_SIZE;
+    uint8 max_board_size = 12u;
+
+    if ((boards_count < 1) ||
+        ((argc >= 2) && (QueensBenchmark_ParseBoardSize(argv[1], &min_board_size) == false)) ||
+        ((argc >= 3) && (QueensBenchmark_ParseBoardSize(argv[2], &max_board_size) == false)))
+    {
+        printf("Expected positive number of boards, board sizes between %d and %d\n", QUEENS_MIN_BOARD_SIZE, QUEENS_MAX_BOARD_SIZE);
+        return 1;
+    }
+
+    const bool bit_parallel_fill = global_config.boardgen_bit_parallel_fill;
+
+    /* both fills have to produce the same distribution of boards, unique share and region sizes are compared along with time */
+    printf("board_size;fill;fill_us;unique_percent;largest_region;smallest_region\n");
+
+    for (uint8 board_size = min_board_size; board_size <= max_board_size; board_size++)
+    {
+        QueensBoard_Board_t board = { 0 };
+        if (QueensBoard_Create(&board, board_size) == false)
+        {
+            printf("Allocation failed!\n");
+            return 1;
+        }
+
+        QueensPermutations_Source_t* source = QueensPermutations_GetSource(board_size);
+        if (source == NULL)
+        {
+            printf("Permutations not available for board size %u!\n", board_size);
+            return 1;
+        }
+
+        for (uint8 fill = 0u; fill < 2u; fill++)
+        {
+            global_config.boardgen_bit_parallel_fill = (fill == 1u);
+
+            double fill_time = 0.0;
+            long unique_count = 0;
+            long largest_region_sum = 0;
+            long smallest_region_sum = 0;
+
+            for (long board_idx = 0; board_idx < boards_count; board_idx++)
+            {
+                /* queens are drawn outside of timed part, only the fill is measured */
+                QueensPermutations_QueenRowIndex_t queens[QUEENS_MAX_BOARD_SIZE];
+                QueensPermutations_Result_t permutation = { 0 };
+                permutation.boards = queens;
+                permutation.boards_count = 1u;
+                permutation.board_size = board_size;
+                permutation.success = QueensPermutations_SourceGetRandom(source, queens);
+
+                const double start_time = QueensBenchmark_GetTimeSeconds();
+                if (QueensBoardGen_Generate(&board, &permutation) != QUEENS_BOARDGEN_SUCCESS)
+                {
+                    printf("Generation failed for board size %u!\n", board_size);
+                    return 1;
+                }
+                fill_time += QueensBenchmark_GetTimeSeconds() - start_time;
+
+                unique_count += (QueensBoardGen_ValidateOnlyOneSolution(&board, NULL) == true) ? 1 : 0;
+
+                uint16 region_sizes[QUEENS_MAX_BOARD_SIZE + 1u] = { 0 };
+                for (uint16 cell_idx = 0u; cell_idx < (uint16)(board_size * board_size); cell_idx++)
+                {
+                    region_sizes[QueensBoard_GetColor(board.board[cell_idx])]++;
+                }
+
+                uint16 largest_region = 0u;
+                uint16 smallest_region = UINT16_MAX;
+                for (uint8 color = 1u; color <= board_size; color++)
+                {
+                    largest_region = (region_sizes[color] > largest_region) ? region_sizes[color] : largest_region;
+                    smallest_region = (region_sizes[color] < smallest_region) ? region_sizes[color] : smallest_region;
+                }
+
+                largest_region_sum += largest_region;
+                smallest_region_sum += smallest_region;
+            }
+
+            printf("%u;%s;%.2f;%.2f;%.2f;%.2f\n",
+                   board_size,
+                   (fill == 1u) ? "bit_parallel" : "scalar",
+                   fill_time * 1e6 / (double)boards_count,
+                   100.0 * (double)unique_count / (double)boards_count,
+                   (double)largest_region_sum / (double)boards_count,
+                   (double)smallest_region_sum / (double)boards_count);
+        }
+
+        QueensBoard_Free(&board);
+    }
+
+    global_config.boardgen_bit_parallel_fill = bit_parallel_fill;
+
+    QueensPermutationsRegistry_Clear();
+    QueensPermutationsIndex_Clear();
+
+    return 0;
+}
+
+/* puzzles generated within time limit per second, generation runs in slices so that the limit is kept */
+static double QueensBenchmark_MeasurePuzzleRate(QueensBoard_Board_t* board, const double time_limit)
+{
+    const uint32 iterations_slice = 32u;
+    const double start_time = QueensBenchmark_GetTimeSeconds();
+    double elapsed_time = 0.0;
+    long found_count = 0;
+
+    while (elapsed_time < time_limit)
+    {
+        uint32 iterations = 0u;
+        const QueensBoardGen_Result_t result = QueensBoardGen_GenerateUnique(board, iterations_slice, &iterations);
+        elapsed_time = QueensBenchmark_GetTimeSeconds() - start_time;
+
+        if (result == QUEENS_BOARDGEN_ERROR)
+        {
+            break;
+        }
+
+        found_count += (result == QUEENS_BOARDGEN_SUCCESS) ? 1 : 0;
+    }
+
+    return (double)found_count / elapsed_time;
+}
+
+static double QueensBenchmark_GetTimeSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static bool QueensBenchmark_ParseBoardSize(const char* arg, uint8* board_size)
+{
+    int parsed_size = atoi(arg);
+
+    if (parsed_size < QUEENS_MIN_BOARD_SIZE || parsed_size > QUEENS_MAX_BOARD_SIZE)
+    {
+        return false;
+    }
+
+    *board_size = (uint8)parsed_size;
+
+    return true;
+}
@@ -150,15 +150,20 @@ void QueensBoard_PrintBoard(const QueensBoard_Board_t* const board)
 }
 
 void QueensBoard_PrintBoardAsString(const QueensBoard_Board_t* board)
+{
+    QueensBoard_WriteBoardAsString(board, stdout);
+}
+
+void QueensBoard_WriteBoardAsString(const QueensBoard_Board_t* board, FILE* file)
 {
     assert(board != NULL);
     assert(board->board != NULL);
 
-    printf("%02u|%02X", board->board_size, board->board[0]);
+    fprintf(file, "%02u|%02X", board->board_size, board->board[0]);
 
     for (uint8 element_idx = 1u; element_idx < board->board_size * board->board_size; element_idx++)
     {
-        printf(",%02X", board->board[element_idx]);
+        fprintf(file, ",%02X", board->board[element_idx]);
     }
 }
 
@@ -1,31 +1,228 @@
 #include <queens_boardgen.h>
+#include <queens_permutations_registry.h>
+#include <queens_permutations_index.h>
+#include <color_scan.h>
+#include <thread_pool.h>
 #include <global_config.h>
 #include <rng.h>
+#include <debug_print.h>
 #include <assert.h>
 #include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
 
 #include <stdlib.h>
 
+/* validations measured with search before AUTO backend is decided for given board size, first ones run on cold caches and memo and are not kept */
+constexpr uint32 QUEENS_BOARDGEN_BACKEND_DISCARDED_SAMPLES = 2u;
+constexpr uint32 QUEENS_BOARDGEN_BACKEND_SAMPLES = 15u;
+/* minimal duration of table scan rate measurement, s */
+constexpr double QUEENS_BOARDGEN_SCAN_RATE_MIN_TIME = 0.01;
+/* table the scan rate is measured on, small enough to be generated in memory right away */
+constexpr QueensPermutation_BoardSize_t QUEENS_BOARDGEN_SCAN_RATE_BOARD_SIZE = 8u;
+/* entries of per-thread memo of memoised search, power of two */
+constexpr uint32 QUEENS_BOARDGEN_MEMO_SIZE = 1u << 14;
+/* slots tried for a state before the first one is overwritten */
+constexpr uint8 QUEENS_BOARDGEN_MEMO_PROBES = 4u;
+/* states with this few columns left are cheaper to search again than to look up */
+constexpr uint8 QUEENS_BOARDGEN_MEMO_MIN_COLUMNS_LEFT = 3u;
+/* cells recolored while repairing one board before it is given up */
+constexpr uint8 QUEENS_BOARDGEN_REPAIR_MAX_EDITS = 8u;
+/* region planes: one 16-bit mask per row (column is bit index, top bit is always past the board), random masks are drawn 2 rows per word */
+constexpr uint8 QUEENS_BOARDGEN_PLANE_ROWS = 16u;
+constexpr uint8 QUEENS_BOARDGEN_PLANE_WORDS = QUEENS_BOARDGEN_PLANE_ROWS * sizeof(uint16) / sizeof(uint32);
+/* bits of random masks are set with probability given in 1/256 steps, one random word per step */
+constexpr uint16 QUEENS_BOARDGEN_MASK_PROBABILITY_ONE = 256u;
+constexpr uint8 QUEENS_BOARDGEN_MASK_DRAWS = 8u;
+/* random masks drawn per region growth pass, cost of one uncolored cell in cell by cell pass in random words of a mask (measured) */
+constexpr uint8 QUEENS_BOARDGEN_GROWTH_MASKS = 7u;
+constexpr uint8 QUEENS_BOARDGEN_FILL_PASS_CELL_COST = 20u;
+/* chances in global_config are drawn as RNG_RandomRange_u32(0, 100) < chance */
+constexpr uint16 QUEENS_BOARDGEN_CHANCE_RANGE = 101u;
+
+/* state of solutions search over prefix tree, colors are tracked per column so nothing has to be undone when walker backtracks */
+typedef struct
+{
+    const QueensBoard_Board_t* board;
+    uint32 used_colors[QUEENS_MAX_BOARD_SIZE + 1u]; /* colors of queens in columns before given one, bit per color */
+    uint32 solutions_count;
+    uint32 max_solutions;
+} QueensBoardGen_TreeSearch_t;
+
+/* state of table-free solutions search, queens are placed column by column straight on the board */
+typedef struct
+{
+    const QueensBoard_Board_t* board;
+    uint16 all_rows;
+    uint32 solutions_count;
+    uint32 max_solutions;
+} QueensBoardGen_Search_t;
+
+/* solutions reachable from state of memoised search (capped at max_solutions), valid only for validation it was stored in */
+typedef struct
+{
+    uint64 state;     /* used rows, used colors and previous row, column is given by number of used rows */
+    uint32 generation;
+    uint32 solutions_count;
+} QueensBoardGen_MemoEntry_t;
+
+/* state of memoised table-free search, boards reached by different orders of the same rows and colors share their completions */
+typedef struct
+{
+    const QueensBoard_Board_t* board;
+    uint16 all_rows;
+    uint32 all_colors;
+    uint32 remaining_colors[QUEENS_MAX_BOARD_SIZE + 1u]; /* colors of cells in given column and columns after it */
+    uint32 generation;
+    uint32 max_solutions;
+    bool uncolored_allowed;                              /* queen may stand on uncolored cell, such cell clashes with no other */
+} QueensBoardGen_Memo_t;
+
+/* cells as bits, words view is used only to draw random masks and to skip empty rows */
+typedef union
+{
+    uint16 rows[QUEENS_BOARDGEN_PLANE_ROWS];
+    uint32 words[QUEENS_BOARDGEN_PLANE_WORDS];
+} QueensBoardGen_Plane_t;
+
+/* regions of board being generated, one plane per color */
+typedef struct
+{
+    QueensBoardGen_Plane_t colors[QUEENS_MAX_BOARD_SIZE + 1u];
+    QueensBoardGen_Plane_t uncolored;
+    uint8 board_size;
+} QueensBoardGen_Regions_t;
+
+/* batch shared by all of its workers */
+typedef struct
+{
+    QueensBoard_Size_t board_size;
+    uint32 boards_count;
+    QueensBoardGen_BatchCallback_t callback;
+    void* context;
+    uint64 seed;                /* workers differ only in stream */
+    atomic_uint claimed_count;  /* boards taken by workers, a board is claimed before it is generated so that no more than boards_count are made */
+    atomic_bool stopped;        /* generation failed or callback wants no more boards */
+    uint32 accepted_count;      /* guarded by mutex, as are callback calls */
+    pthread_mutex_t mutex;
+} QueensBoardGen_Batch_t;
+
+typedef struct
+{
+    QueensBoardGen_Batch_t* batch;
+    uint64 stream;
+} QueensBoardGen_BatchJob_t;
+
+/* state of search for a solution other than the planted one, queens are recorded so that the solution can be repaired */
+typedef struct
+{
+    const QueensBoard_Board_t* board;
+    const QueensPermutations_QueenRowIndex_t* planted;
+    QueensPermutations_QueenRowIndex_t* rows;    /* rows of queens in columns before given one, the solution once found */
+    uint16 all_rows;
+    bool found;
+} QueensBoardGen_OtherSearch_t;
+
+/* kept times of AUTO backend measurement, medians are compared */
+typedef struct
+{
+    double search_times[QUEENS_BOARDGEN_BACKEND_SAMPLES];
+    double memo_times[QUEENS_BOARDGEN_BACKEND_SAMPLES];
+    double index_times[QUEENS_BOARDGEN_BACKEND_SAMPLES];
+    uint32 discarded_count;
+} QueensBoardGen_BackendSamples_t;
+
+/* what is known about solutions of partially colored board during generation */
+typedef enum
+{
+    QUEENS_BOARDGEN_UNIQUENESS_UNKNOWN = 0,    /* board has to be validated once colored */
+    QUEENS_BOARDGEN_UNIQUENESS_UNIQUE = 1,     /* no coloring of remaining cells can add a solution */
+    QUEENS_BOARDGEN_UNIQUENESS_NOT_UNIQUE = 2  /* second solution already stands on colored cells, board is left partially colored */
+} QueensBoardGen_Uniqueness_t;
+
 static uint8 QueensBoardGen_GetCellNeighbors(const QueensBoard_Board_t* board, const uint8 row, const uint8 column, int neighbors[4][2], bool only_horizontal, bool only_vertical);
+static QueensPermutations_Visit_t QueensBoardGen_VisitTreePrefix(void* context, const uint8 column, const QueensPermutations_QueenRowIndex_t row);
+static uint32 QueensBoardGen_CountSolutions(const QueensBoard_Board_t* board, const QueensPermutations_Result_t* permutations, const uint32 max_solutions);
+static uint32 QueensBoardGen_CountSolutionsSharded(const QueensBoard_Board_t* board, const QueensPermutations_Shards_t* shards, const uint32 max_solutions, bool* const failed);
+static uint32 QueensBoardGen_CountSolutionsColumnMajor(const QueensBoard_Board_t* board, const QueensPermutations_Result_t* permutations, const uint32 max_solutions);
+static uint32 QueensBoardGen_CountSolutionsStream(const QueensBoard_Board_t* board, const uint32 max_solutions);
+static QueensBoardGen_Backend_t QueensBoardGen_ResolveBackend(const QueensBoard_Size_t board_size, bool* const measure);
+static void QueensBoardGen_RecordTimes(const QueensBoard_Size_t board_size, const double search_time, const double memo_time, const QueensPermutationsIndex_t* const index, const double index_time);
+static double QueensBoardGen_GetTableScanRate(void);
+static double QueensBoardGen_GetMedian(const double* const samples, const uint32 samples_count);
+static double QueensBoardGen_GetTime(void);
+static uint32 QueensBoardGen_SearchSolutions(const QueensBoard_Board_t* board, const uint32 max_solutions);
+static QueensBoardGen_Result_t QueensBoardGen_GenerateChecked(QueensBoard_Board_t* board, QueensPermutations_Result_t* permutation, QueensBoardGen_Uniqueness_t* const uniqueness, QueensPermutations_QueenRowIndex_t* const planted);
+static void* QueensBoardGen_BatchWorker(void* arg);
+static void QueensBoardGen_FinishMeasurement(const QueensBoard_Board_t* board);
+static void QueensBoardGen_PrepareBackend(const QueensBoard_Size_t board_size, const QueensBoardGen_Backend_t backend);
+static void* QueensBoardGen_WarmUpWorker(void* arg);
+static bool QueensBoardGen_BatchGenerateOne(QueensBoardGen_Batch_t* batch, QueensBoard_Board_t* board);
+static uint16 QueensBoardGen_FillPass(QueensBoard_Board_t* board, uint16* const colored_cells_count);
+static void QueensBoardGen_RegionsInit(QueensBoardGen_Regions_t* regions, const QueensBoard_Board_t* board);
+static uint16 QueensBoardGen_GrowRegions(QueensBoardGen_Regions_t* regions, QueensBoard_Board_t* board, uint16* const colored_cells_count);
+static bool QueensBoardGen_IsGrowthCheaper(const QueensBoardGen_Regions_t* regions);
+static uint16 QueensBoardGen_SpreadRight(const uint16 cells, const uint16 through);
+static QueensBoardGen_Plane_t QueensBoardGen_RandomPlane(const QueensBoardGen_Plane_t* needed, const uint16 probability);
+static uint16 QueensBoardGen_GetMaskProbability(const uint8 chance);
+static bool QueensBoardGen_Repair(QueensBoard_Board_t* board, const QueensPermutations_QueenRowIndex_t* const planted);
+static bool QueensBoardGen_RecolorQueenCell(QueensBoard_Board_t* board, const QueensPermutations_QueenRowIndex_t* const planted, const QueensPermutations_QueenRowIndex_t* const other);
+static bool QueensBoardGen_IsRegionConnectedWithout(const QueensBoard_Board_t* board, const QueensPermutations_QueenRowIndex_t* const planted, const uint8 row, const uint8 column);
+static bool QueensBoardGen_FindOtherSolution(const QueensBoard_Board_t* board, const QueensPermutations_QueenRowIndex_t* const planted, QueensPermutations_QueenRowIndex_t* const other);
+static void QueensBoardGen_FindOtherColumn(QueensBoardGen_OtherSearch_t* search, const uint8 column, const uint16 used_rows, const uint32 used_colors, const bool differs);
+static bool QueensBoardGen_IsFullyColored(const QueensBoard_Board_t* board);
+static QueensBoardGen_Uniqueness_t QueensBoardGen_CheckPartial(const QueensBoard_Board_t* board);
+static uint32 QueensBoardGen_MemoSolutions(const QueensBoard_Board_t* board, const uint32 max_solutions, const bool uncolored_allowed);
+static uint32 QueensBoardGen_MemoColumn(const QueensBoardGen_Memo_t* memo, const uint8 column, const uint16 used_rows, const uint32 used_colors, const sint8 previous_row);
+static void QueensBoardGen_SearchColumn(QueensBoardGen_Search_t* search, const uint8 column, const uint16 used_rows, const uint32 used_colors, const sint8 previous_row);
+
+/* AUTO backend choice per board size, guarded by mutex since boards may be validated from many threads */
+static QueensBoardGen_BackendStats_t QueensBoardGen_backend_stats[QUEENS_MAX_BOARD_SIZE + 1u];
+static QueensBoardGen_BackendSamples_t QueensBoardGen_backend_samples[QUEENS_MAX_BOARD_SIZE + 1u];
+static double QueensBoardGen_table_scan_rate; /* s per permutation, 0 - not measured yet */
+static pthread_mutex_t QueensBoardGen_backend_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* memo is per thread, entries of previous validations are told apart by generation so nothing has to be cleared */
+static thread_local QueensBoardGen_MemoEntry_t QueensBoardGen_memo[QUEENS_BOARDGEN_MEMO_SIZE];
+static thread_local uint32 QueensBoardGen_memo_generation;
+
+/* threads of column-major table scan started from this thread, 0 - global_config.boardgen_scan_threads */
+static thread_local uint8 QueensBoardGen_scan_threads;
 
 QueensBoardGen_Result_t QueensBoardGen_Generate(QueensBoard_Board_t* board, QueensPermutations_Result_t* permutation)
+{
+    return QueensBoardGen_GenerateChecked(board, permutation, NULL, NULL);
+}
+
+/* uniqueness NULL - board is only colored, otherwise its solutions are checked after every flood fill pass. planted receives row of queen in every column if not NULL */
+static QueensBoardGen_Result_t QueensBoardGen_GenerateChecked(QueensBoard_Board_t* board, QueensPermutations_Result_t* permutation, QueensBoardGen_Uniqueness_t* const uniqueness, QueensPermutations_QueenRowIndex_t* const planted)
 {
     QueensBoardGen_Result_t result = QUEENS_BOARDGEN_ERROR;
 
+    if (uniqueness != NULL)
+    {
+        *uniqueness = QUEENS_BOARDGEN_UNIQUENESS_UNKNOWN;
+    }
+
     if (board->board_size < QUEENS_MIN_BOARD_SIZE || board->board_size > QUEENS_MAX_BOARD_SIZE)
     {
         return result;
     }
 
-    bool permutation_provided_externally = true;
+    QueensPermutations_QueenRowIndex_t random_board[QUEENS_MAX_BOARD_SIZE];
     QueensPermutations_Result_t random_permutation = { 0 };
 
-    /* no permutation provided externally, create new one */
+    /* no permutation provided externally, draw one from shared source straight into stack buffer */
     if (permutation == NULL)
     {
-        random_permutation = QueensPermutations_GetRandom(board->board_size);
+        QueensPermutations_Source_t* source = QueensPermutations_GetSource(board->board_size);
+
+        random_permutation.boards = random_board;
+        random_permutation.boards_count = 1u;
+        random_permutation.board_size = board->board_size;
+        random_permutation.success = (source != NULL) && QueensPermutations_SourceGetRandom(source, random_board);
         permutation = &random_permutation;
-        permutation_provided_externally = false;
     }
     else
     {
@@ -57,57 +254,65 @@ QueensBoardGen_Result_t QueensBoardGen_Generate(QueensBoard_Board_t* board, Quee
     QueensBoard_ZeroeBoard(board);
 
     /* Place a queen and apply a color */
+    QueensPermutations_QueenRowIndex_t board_buffer[QUEENS_MAX_BOARD_SIZE];
+    const QueensPermutations_QueenRowIndex_t* queens = QueensPermutations_GetBoard(permutation, 0u, board_buffer);
+
     for (uint8 row = 0; row < board->board_size; row++)
     {
-        board->board[permutation->boards[row]*board->board_size + row] = (row+1u);
+        board->board[queens[row]*board->board_size + row] = (row+1u);
     }
 
-    if (permutation_provided_externally == false)
+    if (planted != NULL)
     {
-        (void)QueensPermutations_FreeResult(permutation);
+        memcpy(planted, queens, board->board_size * sizeof(QueensPermutations_QueenRowIndex_t));
     }
 
     uint16 non_color_cells_count = 0u;
 
-    /* multi-pass flood fill */
+    /* multi-pass flood fill, regions grow from the queens. Both passes color the same way, so few last cells are left to the cell by cell one */
+    bool bit_parallel = global_config.boardgen_bit_parallel_fill;
+    QueensBoardGen_Regions_t regions;
+
+    if (bit_parallel == true)
+    {
+        QueensBoardGen_RegionsInit(&regions, board);
+    }
+
     do
     {
-        non_color_cells_count = 0u;
+        uint16 colored_cells_count = 0u;
+        bit_parallel = (bit_parallel == true) && (QueensBoardGen_IsGrowthCheaper(&regions) == true);
+        non_color_cells_count = (bit_parallel == true) ? QueensBoardGen_GrowRegions(&regions, board, &colored_cells_count) :
+                                                         QueensBoardGen_FillPass(board, &colored_cells_count);
 
-        for (uint8 row = 0; row < board->board_size; row++)
+        /* coloring only removes solutions, so checks of partial board hold for the final one. Fully colored board is left to validation */
+        if ((uniqueness != NULL) &&
+            (*uniqueness == QUEENS_BOARDGEN_UNIQUENESS_UNKNOWN) &&
+            (colored_cells_count > 0u) &&
+            (colored_cells_count < non_color_cells_count))
         {
-            for (uint8 column = 0; column < board->board_size; column++)
-            {
-                if (QueensBoard_GetColor(board->board[IDX(row, column, board->board_size)]) == COLOR_NONE)
-                {
-                    non_color_cells_count++;
+            *uniqueness = QueensBoardGen_CheckPartial(board);
 
-                    /* introduce randomness */
-                    if (RNG_RandomRange_u32(0, 100) < global_config.boardgen_cell_skip_chance)
-                    {
-                        continue;
-                    }
-
-                    bool only_horizontal = (RNG_RandomRange_u32(0, 100) < global_config.boardgen_only_horizontal_neighbor_chance);
-                    bool only_vertical = (RNG_RandomRange_u32(0, 100) < global_config.boardgen_only_vertical_neighbor_chance);
-                    int neighbors[4][2] = { 0 };
-                    uint8 neighbors_count = QueensBoardGen_GetCellNeighbors(board, row, column, neighbors, only_horizontal, only_vertical);
+            /* second solution on colored cells is broken the same way as on fully colored board, coloring goes on then */
+            if ((*uniqueness == QUEENS_BOARDGEN_UNIQUENESS_NOT_UNIQUE) &&
+                (planted != NULL) &&
+                (global_config.boardgen_repair == true) &&
+                (QueensBoardGen_Repair(board, planted) == true))
+            {
+                *uniqueness = QUEENS_BOARDGEN_UNIQUENESS_UNKNOWN;
 
-                    for (uint8 i = 0; i < neighbors_count; i++)
-                    {
-                        if (RNG_RandomRange_u32(0, 100) < global_config.boardgen_neighbor_skip_chance)
-                        {
-                            continue;
-                        }
-
-                        if (QueensBoard_GetColor(board->board[IDX(neighbors[i][0], neighbors[i][1], board->board_size)]) != COLOR_NONE)
-                        {
-                            QueensBoard_SetColor(&board->board[IDX(row, column, board->board_size)], QueensBoard_GetColor(board->board[IDX(neighbors[i][0], neighbors[i][1], board->board_size)]));
-                            break;
-                        }
-                    }
+                /* repair recolored some cells */
+                if (bit_parallel == true)
+                {
+                    QueensBoardGen_RegionsInit(&regions, board);
                 }
             }
+
+            /* rest of the board doesn't matter anymore */
+            if (*uniqueness == QUEENS_BOARDGEN_UNIQUENESS_NOT_UNIQUE)
+            {
+                return QUEENS_BOARDGEN_SUCCESS;
+            }
         }
     }
     while (non_color_cells_count > 0u);
@@ -117,18 +322,245 @@ QueensBoardGen_Result_t QueensBoardGen_Generate(QueensBoard_Board_t* board, Quee
     return result;
 }
 
+QueensBoardGen_Result_t QueensBoardGen_GenerateUnique(QueensBoard_Board_t* board, const uint32 max_iterations, uint32* iterations)
+{
+    /* validation picks its backend per board size, full table is held by the registry only if that pays off */
+    QueensBoardGen_Result_t result = QUEENS_BOARDGEN_SUCCESS;
+    QueensBoardGen_Uniqueness_t uniqueness = QUEENS_BOARDGEN_UNIQUENESS_UNKNOWN;
+    QueensPermutations_QueenRowIndex_t planted[QUEENS_MAX_BOARD_SIZE];
+    bool unique = false;
+    *iterations = 0u;
+
+    do
+    {
+        if ((max_iterations != 0u) &&
+            (*iterations >= max_iterations))
+        {
+            result = QUEENS_BOARDGEN_ITERATIONS_EXCEEDED;
+            break;
+        }
+
+        /* candidates with a second solution are dropped as soon as it appears, proven ones skip validation */
+        result = QueensBoardGen_GenerateChecked(board, NULL, (global_config.boardgen_incremental_check == true) ? &uniqueness : NULL, planted);
+        (*iterations)++;
+
+        if ((result != QUEENS_BOARDGEN_SUCCESS) ||
+            (uniqueness == QUEENS_BOARDGEN_UNIQUENESS_NOT_UNIQUE))
+        {
+            continue;
+        }
+
+        unique = (uniqueness == QUEENS_BOARDGEN_UNIQUENESS_UNIQUE) ||
+                 (QueensBoardGen_ValidateOnlyOneSolution(board, NULL) == true);
+
+        /* fully colored board got its extra solutions only in the last passes, a few recolored cells are cheaper than a new board */
+        if ((unique == false) &&
+            (global_config.boardgen_repair == true))
+        {
+            unique = QueensBoardGen_Repair(board, planted);
+        }
+    } while ((result == QUEENS_BOARDGEN_SUCCESS) &&
+             (unique == false));
+
+    return result;
+}
+
+uint32 QueensBoardGen_GenerateBatch(const QueensBoard_Size_t board_size, const uint32 boards_count, uint8 threads_count, const QueensBoardGen_BatchCallback_t callback, void* const context)
+{
+    if ((board_size < QUEENS_MIN_BOARD_SIZE) ||
+        (board_size > QUEENS_MAX_BOARD_SIZE) ||
+        (boards_count == 0u) ||
+        (callback == NULL))
+    {
+        return 0u;
+    }
+
+    QueensBoardGen_Batch_t batch = {
+        .board_size = board_size,
+        .boards_count = boards_count,
+        .callback = callback,
+        .context = context,
+        .seed = RNG_Random_u64(), /* batch follows seed of calling thread */
+        .accepted_count = 0u
+    };
+    atomic_init(&batch.claimed_count, 0u);
+    atomic_init(&batch.stopped, false);
+    pthread_mutex_init(&batch.mutex, NULL);
+
+    /*
+        first board is made by calling thread, which also finishes AUTO measurement on it (incremental check may have accepted it without any validation).
+        Once the backend is decided its source, table or index is loaded, so that workers don't measure under contention and only read shared data
+    */
+    QueensBoard_Board_t board = { 0 };
+    if (QueensBoard_Create(&board, board_size) == true)
+    {
+        if (QueensBoardGen_BatchGenerateOne(&batch, &board) == true)
+        {
+            QueensBoardGen_FinishMeasurement(&board);
+            QueensBoardGen_PrepareBackend(board_size, QueensBoardGen_GetBackend(board_size));
+        }
+    }
+    else
+    {
+        assert(false);
+        atomic_store(&batch.stopped, true);
+    }
+
+    if (board.board != NULL)
+    {
+        QueensBoard_Free(&board);
+    }
+
+    /* calling thread is the first worker */
+    if ((boards_count > 1u) &&
+        (atomic_load(&batch.stopped) == false))
+    {
+        const uint8 workers_count = ThreadPool_GetThreadsCount(threads_count, boards_count - 1u);
+        QueensBoardGen_BatchJob_t jobs[THREAD_POOL_MAX_THREADS];
+
+        for (uint8 job_idx = 0u; job_idx < workers_count; job_idx++)
+        {
+            jobs[job_idx] = (QueensBoardGen_BatchJob_t){ .batch = &batch, .stream = job_idx + 1u };
+        }
+
+        ThreadPool_Run(QueensBoardGen_BatchWorker, jobs, sizeof(QueensBoardGen_BatchJob_t), workers_count);
+    }
+
+    pthread_mutex_destroy(&batch.mutex);
+
+    return batch.accepted_count;
+}
+
+bool QueensBoardGen_StartWarmUp(const uint32 board_sizes_mask)
+{
+    /* mask travels in the pointer itself, nothing has to outlive this call */
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, QueensBoardGen_WarmUpWorker, (void*)(uintptr_t)board_sizes_mask) != 0)
+    {
+        return false;
+    }
+
+    (void)pthread_detach(thread);
+
+    return true;
+}
+
 bool QueensBoardGen_ValidateOnlyOneSolution(const QueensBoard_Board_t* board, const QueensPermutations_Result_t* permutations)
+{
+    return QueensBoardGen_ValidateOnlyOneSolutionWith(board, permutations, (QueensBoardGen_Backend_t)global_config.boardgen_uniqueness_backend);
+}
+
+bool QueensBoardGen_ValidateOnlyOneSolutionWith(const QueensBoard_Board_t* board, const QueensPermutations_Result_t* permutations, QueensBoardGen_Backend_t backend)
 {
     assert(board != NULL);
     assert(board->board != NULL);
 
-    QueensPermutations_Result_t all_permutations = { 0 };
+    /* backends disagree on what an uncolored cell is, board left partially colored (iterations exceeded) is no puzzle anyway */
+    if (QueensBoardGen_IsFullyColored(board) == false)
+    {
+        return false;
+    }
+
+    uint32 solutions_count = 0u;
 
     /* check if permutations were provided externally */
     if (permutations == NULL)
     {
-        all_permutations = QueensPermutations_GetAll(board->board_size);
-        permutations = &all_permutations;
+        bool measure = false;
+        if (backend == QUEENS_BOARDGEN_BACKEND_AUTO)
+        {
+            backend = QueensBoardGen_ResolveBackend(board->board_size, &measure);
+        }
+
+        const QueensPermutations_Result_t* table = NULL;
+        const QueensPermutations_Shards_t* shards = NULL;
+        const QueensPermutationsIndex_t* index = NULL;
+
+        switch (backend)
+        {
+            case QUEENS_BOARDGEN_BACKEND_TABLE:
+                /* registry keeps the table loaded between calls, until it is evicted over the budget */
+                table = QueensPermutationsRegistry_Acquire(board->board_size);
+                if (table != NULL)
+                {
+                    solutions_count = QueensBoardGen_CountSolutions(board, table, 2u);
+                    QueensPermutationsRegistry_Release(table);
+                    break;
+                }
+
+                /* table doesn't fit or couldn't be loaded, search needs no table */
+                solutions_count = QueensBoardGen_SearchSolutions(board, 2u);
+                break;
+            case QUEENS_BOARDGEN_BACKEND_STREAM:
+                solutions_count = QueensBoardGen_CountSolutionsStream(board, 2u);
+                break;
+            case QUEENS_BOARDGEN_BACKEND_SHARDS:
+                shards = QueensPermutations_GetShards(board->board_size);
+                if (shards != NULL)
+                {
+                    bool failed = false;
+                    solutions_count = QueensBoardGen_CountSolutionsSharded(board, shards, 2u, &failed);
+
+                    /* shard couldn't be loaded, board can't be confirmed */
+                    if (failed == true)
+                    {
+                        solutions_count = 0u;
+                    }
+                    break;
+                }
+
+                solutions_count = QueensBoardGen_SearchSolutions(board, 2u);
+                break;
+            case QUEENS_BOARDGEN_BACKEND_INDEX:
+                index = QueensPermutationsIndex_Acquire(board->board_size);
+                if (index != NULL)
+                {
+                    solutions_count = QueensPermutationsIndex_CountSolutions(index, board, 2u);
+                    QueensPermutationsIndex_Release(index);
+                    break;
+                }
+
+                /* index is over the budget */
+                solutions_count = QueensBoardGen_SearchSolutions(board, 2u);
+                break;
+            case QUEENS_BOARDGEN_BACKEND_MEMO:
+                solutions_count = QueensBoardGen_MemoSolutions(board, 2u, false);
+                break;
+            case QUEENS_BOARDGEN_BACKEND_AUTO:
+            case QUEENS_BOARDGEN_BACKEND_SEARCH:
+            default:
+                if (measure == true)
+                {
+                    /* index is built before timing, only counting is compared */
+                    index = QueensPermutationsIndex_Acquire(board->board_size);
+
+                    double start_time = QueensBoardGen_GetTime();
+                    solutions_count = QueensBoardGen_SearchSolutions(board, 2u);
+                    const double search_time = QueensBoardGen_GetTime() - start_time;
+
+                    start_time = QueensBoardGen_GetTime();
+                    [[maybe_unused]] const uint32 memo_solutions_count = QueensBoardGen_MemoSolutions(board, 2u, false);
+                    const double memo_time = QueensBoardGen_GetTime() - start_time;
+                    assert(memo_solutions_count == solutions_count);
+
+                    double index_time = 0.0;
+                    if (index != NULL)
+                    {
+                        start_time = QueensBoardGen_GetTime();
+                        [[maybe_unused]] const uint32 index_solutions_count = QueensPermutationsIndex_CountSolutions(index, board, 2u);
+                        index_time = QueensBoardGen_GetTime() - start_time;
+                        assert(index_solutions_count == solutions_count);
+                    }
+
+                    QueensBoardGen_RecordTimes(board->board_size, search_time, memo_time, index, index_time);
+                    QueensPermutationsIndex_Release(index);
+                }
+                else
+                {
+                    solutions_count = QueensBoardGen_SearchSolutions(board, 2u);
+                }
+                break;
+        }
     }
     else
     {
@@ -136,61 +568,1217 @@ bool QueensBoardGen_ValidateOnlyOneSolution(const QueensBoard_Board_t* board, co
         {
             return false;
         }
+
+        if (permutations->success == false)
+        {
+            return false;
+        }
+
+        solutions_count = QueensBoardGen_CountSolutions(board, permutations, 2u);
     }
 
+    return (solutions_count == 1u);
+}
+
+QueensBoardGen_Backend_t QueensBoardGen_GetBackend(const QueensBoard_Size_t board_size)
+{
+    bool measure = false;
+    const QueensBoardGen_Backend_t configured_backend = (QueensBoardGen_Backend_t)global_config.boardgen_uniqueness_backend;
+
+    return (configured_backend != QUEENS_BOARDGEN_BACKEND_AUTO) ? configured_backend : QueensBoardGen_ResolveBackend(board_size, &measure);
+}
+
+QueensBoardGen_BackendStats_t QueensBoardGen_GetBackendStats(const QueensBoard_Size_t board_size)
+{
+    QueensBoardGen_BackendStats_t stats = { 0 };
 
-    if (permutations->success == false)
+    if ((board_size >= QUEENS_MIN_BOARD_SIZE) &&
+        (board_size <= QUEENS_MAX_BOARD_SIZE))
     {
-        return false;
+        pthread_mutex_lock(&QueensBoardGen_backend_mutex);
+        stats = QueensBoardGen_backend_stats[board_size];
+        pthread_mutex_unlock(&QueensBoardGen_backend_mutex);
     }
 
-    /* For each permutation, check if each queen has a unique color. There has to be exactly one permutation that meets this criteria */
-    /* Create an array that stores colors and make sure it consists of unique elements */
-    uint8* colors = (uint8*)calloc(board->board_size+1u, sizeof(uint8));
-    if (colors == NULL)
+    return stats;
+}
+
+const char* QueensBoardGen_GetBackendName(const QueensBoardGen_Backend_t backend)
+{
+    switch (backend)
     {
-        return false;
+        case QUEENS_BOARDGEN_BACKEND_AUTO:
+            return "auto";
+        case QUEENS_BOARDGEN_BACKEND_TABLE:
+            return "table";
+        case QUEENS_BOARDGEN_BACKEND_STREAM:
+            return "stream";
+        case QUEENS_BOARDGEN_BACKEND_SHARDS:
+            return "shards";
+        case QUEENS_BOARDGEN_BACKEND_SEARCH:
+            return "search";
+        case QUEENS_BOARDGEN_BACKEND_INDEX:
+            return "index";
+        case QUEENS_BOARDGEN_BACKEND_MEMO:
+            return "memo";
     }
 
-    bool one_solution = false;
+    return "unknown";
+}
+
+/*
+    AUTO backend: sharded store if configured, otherwise first validations of given size are searched and timed
+    (with memoised search and permutations index too, the index only if it fits the memory budget).
+    Fastest of search, memoised search, index and full table (estimated scan, only if it fits the budget) is chosen
+*/
+static QueensBoardGen_Backend_t QueensBoardGen_ResolveBackend(const QueensBoard_Size_t board_size, bool* const measure)
+{
+    *measure = false;
 
-    for (uint32 permutation_idx = 0; permutation_idx < permutations->boards_count; permutation_idx++)
+    if (global_config.permutations_sharded == true)
     {
-        bool valid_permutation = true;
+        return QUEENS_BOARDGEN_BACKEND_SHARDS;
+    }
 
-        for (uint8 column = 0; column < board->board_size; column++)
+    if ((board_size < QUEENS_MIN_BOARD_SIZE) ||
+        (board_size > QUEENS_MAX_BOARD_SIZE))
+    {
+        return QUEENS_BOARDGEN_BACKEND_SEARCH;
+    }
+
+    pthread_mutex_lock(&QueensBoardGen_backend_mutex);
+    const QueensBoardGen_Backend_t backend = QueensBoardGen_backend_stats[board_size].backend;
+    pthread_mutex_unlock(&QueensBoardGen_backend_mutex);
+
+    if (backend == QUEENS_BOARDGEN_BACKEND_AUTO)
+    {
+        *measure = true;
+        return QUEENS_BOARDGEN_BACKEND_SEARCH;
+    }
+
+    return backend;
+}
+
+static void QueensBoardGen_RecordTimes(const QueensBoard_Size_t board_size, const double search_time, const double memo_time, const QueensPermutationsIndex_t* const index, const double index_time)
+{
+    bool drop_index = false;
+
+    pthread_mutex_lock(&QueensBoardGen_backend_mutex);
+
+    QueensBoardGen_BackendStats_t* stats = &QueensBoardGen_backend_stats[board_size];
+
+    /* other thread may have decided meanwhile */
+    if (stats->backend == QUEENS_BOARDGEN_BACKEND_AUTO)
+    {
+        QueensBoardGen_BackendSamples_t* samples = &QueensBoardGen_backend_samples[board_size];
+
+        if (samples->discarded_count < QUEENS_BOARDGEN_BACKEND_DISCARDED_SAMPLES)
         {
-            uint8 color = QueensBoard_GetColor(board->board[IDX(permutations->boards[permutation_idx*board->board_size + column], column, board->board_size)]);
-            if (colors[color] == 1u)
-            {
-                valid_permutation = false;
-                break;
-            }
-            else
-            {
-                colors[color] = 1u;
-            }
+            samples->discarded_count++;
         }
+        else
+        {
+            samples->search_times[stats->search_samples] = search_time;
+            samples->memo_times[stats->search_samples] = memo_time;
+            samples->index_times[stats->search_samples] = index_time;
+            stats->search_samples++;
 
-        if (valid_permutation)
+            stats->search_time = QueensBoardGen_GetMedian(samples->search_times, stats->search_samples);
+            stats->memo_time = QueensBoardGen_GetMedian(samples->memo_times, stats->search_samples);
+            stats->index_time = QueensBoardGen_GetMedian(samples->index_times, stats->search_samples);
+        }
+        stats->index_size = (index != NULL) ? QueensPermutationsIndex_GetSize(index) : 0u;
+
+        if (stats->search_samples >= QUEENS_BOARDGEN_BACKEND_SAMPLES)
         {
-            if (one_solution)
+            const uint64 permutations_count = QueensPermutations_GetCount(board_size);
+            const bool packed = (global_config.permutations_compressed == true) && (global_config.permutations_keep_packed == true) &&
+                                (global_config.permutations_column_major == false);
+            const size_t budget = global_config.permutations_registry_budget;
+
+            stats->table_size = permutations_count * board_size / (packed ? 2u : 1u);
+            stats->table_scan_time = (double)permutations_count * QueensBoardGen_GetTableScanRate();
+
+            const bool table_fits = (QueensPermutations_TableFits(board_size) == true) &&
+                                    ((budget == 0u) || (stats->table_size <= budget));
+
+            double best_time = stats->search_time;
+            stats->backend = QUEENS_BOARDGEN_BACKEND_SEARCH;
+
+            if (stats->memo_time < best_time)
             {
-                one_solution = false;
-                break;
+                best_time = stats->memo_time;
+                stats->backend = QUEENS_BOARDGEN_BACKEND_MEMO;
             }
-            else
+
+            if ((index != NULL) && (stats->index_time < best_time))
+            {
+                best_time = stats->index_time;
+                stats->backend = QUEENS_BOARDGEN_BACKEND_INDEX;
+            }
+
+            if ((table_fits == true) && (stats->table_scan_time < best_time))
             {
-                one_solution = true;
+                stats->backend = QUEENS_BOARDGEN_BACKEND_TABLE;
             }
+
+            debug_print("Uniqueness backend for board size %u: %s (search %.1f us, memo %.1f us, index %.1f us, table scan %.1f us, index %llu bytes, table %llu bytes)\n",
+                        board_size,
+                        QueensBoardGen_GetBackendName(stats->backend),
+                        stats->search_time * 1e6,
+                        stats->memo_time * 1e6,
+                        stats->index_time * 1e6,
+                        stats->table_scan_time * 1e6,
+                        (unsigned long long)stats->index_size,
+                        (unsigned long long)stats->table_size);
+
+            /* index was built only for calibration */
+            drop_index = (stats->backend != QUEENS_BOARDGEN_BACKEND_INDEX);
         }
+    }
 
-        memset(colors, 0, board->board_size+1);
+    pthread_mutex_unlock(&QueensBoardGen_backend_mutex);
+
+    if (drop_index == true)
+    {
+        QueensPermutationsIndex_Drop(board_size);
+    }
+}
+
+/* median of given samples, they are left in the order they were taken */
+static double QueensBoardGen_GetMedian(const double* const samples, const uint32 samples_count)
+{
+    double sorted[QUEENS_BOARDGEN_BACKEND_SAMPLES];
+
+    assert((samples_count > 0u) && (samples_count <= QUEENS_BOARDGEN_BACKEND_SAMPLES));
+
+    /* insertion sort, a handful of samples */
+    for (uint32 i = 0u; i < samples_count; i++)
+    {
+        uint32 j = i;
+        for (; (j > 0u) && (sorted[j - 1u] > samples[i]); j--)
+        {
+            sorted[j] = sorted[j - 1u];
+        }
+        sorted[j] = samples[i];
+    }
+
+    if ((samples_count % 2u) == 1u)
+    {
+        return sorted[samples_count / 2u];
     }
 
-    free(colors);
+    return (sorted[samples_count / 2u - 1u] + sorted[samples_count / 2u]) / 2.0;
+}
+
+/* s per permutation of full scan, measured once on a small table generated in memory. Called with backend mutex held */
+static double QueensBoardGen_GetTableScanRate(void)
+{
+    if (QueensBoardGen_table_scan_rate > 0.0)
+    {
+        return QueensBoardGen_table_scan_rate;
+    }
+
+    const QueensPermutation_BoardSize_t board_size = QUEENS_BOARDGEN_SCAN_RATE_BOARD_SIZE;
+    QueensPermutations_Result_t table = QueensPermutations_Generate(board_size, 1u);
+    QueensBoard_Board_t board = { 0 };
+
+    /* measured on the layout registry keeps tables in */
+    if ((global_config.permutations_column_major == true) &&
+        (table.success == true))
+    {
+        const QueensPermutations_Result_t column_major_table = QueensPermutations_ToColumnMajor(&table);
+        (void)QueensPermutations_FreeResult(&table);
+        table = column_major_table;
+    }
+
+    if ((table.success == false) ||
+        (QueensBoard_Create(&board, board_size) == false))
+    {
+        (void)QueensPermutations_FreeResult(&table);
+        return 0.0;
+    }
+
+    /* fixed irregular coloring, queens clash on colors after a few columns like on generated boards */
+    for (uint8 row = 0u; row < board_size; row++)
+    {
+        for (uint8 column = 0u; column < board_size; column++)
+        {
+            QueensBoard_SetColor(&board.board[IDX(row, column, board_size)], (QueensBoard_Cell_t)(((row * 3u + column * 5u + row * column) % board_size) + 1u));
+        }
+    }
+
+    uint64 scanned_count = 0u;
+    const double start_time = QueensBoardGen_GetTime();
+    double elapsed_time = 0.0;
+
+    do
+    {
+        (void)QueensBoardGen_CountSolutions(&board, &table, UINT32_MAX);
+        scanned_count += table.boards_count;
+        elapsed_time = QueensBoardGen_GetTime() - start_time;
+    } while (elapsed_time < QUEENS_BOARDGEN_SCAN_RATE_MIN_TIME);
+
+    QueensBoardGen_table_scan_rate = elapsed_time / (double)scanned_count;
+
+    QueensBoard_Free(&board);
+    (void)QueensPermutations_FreeResult(&table);
+
+    return QueensBoardGen_table_scan_rate;
+}
+
+static double QueensBoardGen_GetTime(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* stream permutations in batches, memory use doesn't depend on board size */
+static uint32 QueensBoardGen_CountSolutionsStream(const QueensBoard_Board_t* board, const uint32 max_solutions)
+{
+    uint32 solutions_count = 0u;
+
+    QueensPermutations_Cursor_t* cursor = QueensPermutations_CursorOpen(board->board_size, QUEENS_PERMUTATIONS_CURSOR_SOURCE_AUTO);
+    if (cursor == NULL)
+    {
+        return 0u;
+    }
+
+    QueensPermutations_Result_t batch = { 0 };
+    while ((solutions_count < max_solutions) &&
+           (QueensPermutations_CursorNextBatch(cursor, &batch) == true))
+    {
+        solutions_count += QueensBoardGen_CountSolutions(board, &batch, max_solutions - solutions_count);
+    }
+
+    /* permutations were incomplete, board can't be confirmed */
+    if (QueensPermutations_CursorFailed(cursor) == true)
+    {
+        solutions_count = 0u;
+    }
+
+    QueensPermutations_CursorClose(cursor);
+
+    return solutions_count;
+}
+
+/* loads only shards whose prefix queens are on different colors, one shard at a time */
+static uint32 QueensBoardGen_CountSolutionsSharded(const QueensBoard_Board_t* board, const QueensPermutations_Shards_t* shards, const uint32 max_solutions, bool* const failed)
+{
+    uint32 solutions_count = 0u;
+    *failed = false;
+
+    for (uint32 shard_idx = 0u; (shard_idx < QueensPermutations_ShardsGetCount(shards)) && (solutions_count < max_solutions); shard_idx++)
+    {
+        const QueensPermutations_QueenRowIndex_t* prefix = QueensPermutations_ShardsGetPrefix(shards, shard_idx);
+
+        uint32 prefix_colors = 0u;
+        bool prefix_valid = true;
+        for (uint8 column = 0u; column < QUEENS_PERMUTATIONS_SHARD_PREFIX_LEN; column++)
+        {
+            const uint32 color_mask = 1u << QueensBoard_GetColor(board->board[IDX(prefix[column], column, board->board_size)]);
+            prefix_valid = prefix_valid && ((prefix_colors & color_mask) == 0u);
+            prefix_colors |= color_mask;
+        }
+
+        if (prefix_valid == false)
+        {
+            continue;
+        }
+
+        QueensPermutations_Result_t shard = QueensPermutations_ShardsLoad(shards, shard_idx);
+        if (shard.success == false)
+        {
+            *failed = true;
+            break;
+        }
+
+        solutions_count += QueensBoardGen_CountSolutions(board, &shard, max_solutions - solutions_count);
+        (void)QueensPermutations_FreeResult(&shard);
+    }
+
+    return solutions_count;
+}
+
+/* counts permutations that put every queen on a different color, stops once max_solutions is reached */
+static uint32 QueensBoardGen_CountSolutions(const QueensBoard_Board_t* board, const QueensPermutations_Result_t* permutations, const uint32 max_solutions)
+{
+    /* For each permutation, check if each queen has a unique color */
+    /* Create an array that stores colors and make sure it consists of unique elements */
+    uint8 colors[QUEENS_MAX_BOARD_SIZE + 1u] = { 0u };
+    uint32 solutions_count = 0u;
+
+    if (permutations->prefix_tree == true)
+    {
+        /* prefixes with repeated color are skipped together with all permutations starting with them */
+        QueensBoardGen_TreeSearch_t search = { .board = board, .max_solutions = max_solutions };
+        (void)QueensPermutations_TraverseTree(permutations, QueensBoardGen_VisitTreePrefix, &search);
+
+        return search.solutions_count;
+    }
+
+    if (permutations->column_major == true)
+    {
+        return QueensBoardGen_CountSolutionsColumnMajor(board, permutations, max_solutions);
+    }
+
+    QueensPermutations_QueenRowIndex_t board_buffer[QUEENS_MAX_BOARD_SIZE];
+
+    for (uint64 permutation_idx = 0; permutation_idx < permutations->boards_count; permutation_idx++)
+    {
+        bool valid_permutation = true;
+
+        /* packed tables are unpacked one board at a time */
+        const QueensPermutations_QueenRowIndex_t* queens = QueensPermutations_GetBoard(permutations, permutation_idx, board_buffer);
+
+        for (uint8 column = 0; column < board->board_size; column++)
+        {
+            uint8 color = QueensBoard_GetColor(board->board[IDX(queens[column], column, board->board_size)]);
+            if (colors[color] == 1u)
+            {
+                valid_permutation = false;
+                break;
+            }
+            else
+            {
+                colors[color] = 1u;
+            }
+        }
+
+        if (valid_permutation)
+        {
+            solutions_count++;
+            if (solutions_count >= max_solutions)
+            {
+                break;
+            }
+        }
+
+        memset(colors, 0, board->board_size+1);
+    }
+
+    return solutions_count;
+}
+
+/* same rules as permutations enumeration, but branches putting a queen on already used color are cut right away */
+/* colors of every column are looked up for many permutations at once, table is split between threads */
+static uint32 QueensBoardGen_CountSolutionsColumnMajor(const QueensBoard_Board_t* board, const QueensPermutations_Result_t* permutations, const uint32 max_solutions)
+{
+    const uint8 board_size = board->board_size;
+    ColorScan_Table_t scan_table = { .columns_count = board_size };
+
+    for (uint8 column = 0u; column < board_size; column++)
+    {
+        scan_table.columns[column] = (const uint8*)&permutations->boards[(size_t)column * permutations->boards_count];
+
+        for (uint8 row = 0u; row < board_size; row++)
+        {
+            const uint8 color = QueensBoard_GetColor(board->board[IDX(row, column, board_size)]);
+            if ((color == COLOR_NONE) || (color > board_size))
+            {
+                return 0u;
+            }
+
+            ColorScan_SetColor(&scan_table, column, row, color);
+        }
+    }
+
+    /* colors 1..board_size */
+    const uint16 all_colors = (uint16)((1u << board_size) - 1u);
+    scan_table.lower_all_colors = (uint8)(all_colors & 0xFFu);
+    scan_table.higher_all_colors = (uint8)(all_colors >> 8u);
+
+    return (uint32)ColorScan_CountParallel(&scan_table, (size_t)permutations->boards_count, max_solutions,
+                                          (QueensBoardGen_scan_threads != 0u) ? QueensBoardGen_scan_threads : global_config.boardgen_scan_threads);
+}
+
+static uint32 QueensBoardGen_SearchSolutions(const QueensBoard_Board_t* board, const uint32 max_solutions)
+{
+    QueensBoardGen_Search_t search = {
+        .board = board,
+        .all_rows = (uint16)((1u << board->board_size) - 1u),
+        .max_solutions = max_solutions
+    };
+
+    QueensBoardGen_SearchColumn(&search, 0u, 0u, 0u, QUEEN_ROW_NOT_EXISTS);
+
+    return search.solutions_count;
+}
+
+static void QueensBoardGen_SearchColumn(QueensBoardGen_Search_t* search, const uint8 column, const uint16 used_rows, const uint32 used_colors, const sint8 previous_row)
+{
+    const uint8 board_size = search->board->board_size;
+
+    if (column == board_size)
+    {
+        search->solutions_count++;
+        return;
+    }
+
+    uint16 rows = (uint16)(search->all_rows & ~used_rows);
+
+    /* queens in adjacent columns can't be in adjacent rows */
+    if (previous_row != QUEEN_ROW_NOT_EXISTS)
+    {
+        const uint32 previous_row_bit = 1u << previous_row;
+        rows &= (uint16)~((previous_row_bit << 1u) | (previous_row_bit >> 1u));
+    }
+
+    for (; (rows != 0u) && (search->solutions_count < search->max_solutions); rows &= (uint16)(rows - 1u))
+    {
+        const uint8 row = (uint8)__builtin_ctz(rows);
+        const uint32 color_bit = 1u << QueensBoard_GetColor(search->board->board[IDX(row, column, board_size)]);
+
+        if ((used_colors & color_bit) == 0u)
+        {
+            QueensBoardGen_SearchColumn(search, column + 1u, (uint16)(used_rows | (1u << row)), used_colors | color_bit, (sint8)row);
+        }
+    }
+}
+
+/* validates board until AUTO backend of its size is decided, nothing to do for configured backend */
+static void QueensBoardGen_FinishMeasurement(const QueensBoard_Board_t* board)
+{
+    bool measure = (global_config.boardgen_uniqueness_backend == QUEENS_BOARDGEN_BACKEND_AUTO);
+    if (measure == true)
+    {
+        (void)QueensBoardGen_ResolveBackend(board->board_size, &measure);
+    }
+
+    while (measure == true)
+    {
+        (void)QueensBoardGen_ValidateOnlyOneSolution(board, NULL);
+        (void)QueensBoardGen_ResolveBackend(board->board_size, &measure);
+    }
+}
+
+/* loads what given backend counts solutions on, so that first validation doesn't wait for it. Search and memo need nothing, stream reads permutations as it goes */
+static void QueensBoardGen_PrepareBackend(const QueensBoard_Size_t board_size, const QueensBoardGen_Backend_t backend)
+{
+    const QueensPermutationsIndex_t* index = NULL;
+
+    switch (backend)
+    {
+        case QUEENS_BOARDGEN_BACKEND_TABLE:
+            QueensPermutationsRegistry_WarmUp(1u << board_size);
+            break;
+        case QUEENS_BOARDGEN_BACKEND_SHARDS:
+            (void)QueensPermutations_GetShards(board_size);
+            break;
+        case QUEENS_BOARDGEN_BACKEND_INDEX:
+            /* index stays built after release, until it is dropped or cleared */
+            index = QueensPermutationsIndex_Acquire(board_size);
+            QueensPermutationsIndex_Release(index);
+            break;
+        case QUEENS_BOARDGEN_BACKEND_AUTO:
+        case QUEENS_BOARDGEN_BACKEND_STREAM:
+        case QUEENS_BOARDGEN_BACKEND_SEARCH:
+        case QUEENS_BOARDGEN_BACKEND_MEMO:
+        default:
+            break;
+    }
+}
+
+/* AUTO backend is decided on a board generated here (its random state is never seeded, board is thrown away), then data of the chosen backend is loaded */
+static void* QueensBoardGen_WarmUpWorker(void* arg)
+{
+    const uint32 board_sizes_mask = (uint32)(uintptr_t)arg;
+
+    for (uint8 board_size = QUEENS_MIN_BOARD_SIZE; board_size <= QUEENS_MAX_BOARD_SIZE; board_size++)
+    {
+        if ((board_sizes_mask & (1u << board_size)) == 0u)
+        {
+            continue;
+        }
+
+        bool measure = false;
+        if (global_config.boardgen_uniqueness_backend == QUEENS_BOARDGEN_BACKEND_AUTO)
+        {
+            (void)QueensBoardGen_ResolveBackend(board_size, &measure);
+        }
+
+        if (measure == true)
+        {
+            QueensBoard_Board_t board = { 0 };
+            if (QueensBoard_Create(&board, board_size) == false)
+            {
+                assert(false);
+                continue;
+            }
+
+            uint32 iterations = 0u;
+            if (QueensBoardGen_GenerateUnique(&board, 0u, &iterations) == QUEENS_BOARDGEN_SUCCESS)
+            {
+                QueensBoardGen_FinishMeasurement(&board);
+            }
+
+            QueensBoard_Free(&board);
+        }
+
+        const QueensBoardGen_Backend_t backend = QueensBoardGen_GetBackend(board_size);
+        debug_print("Uniqueness backend warm-up of board size %u: %s\n", board_size, QueensBoardGen_GetBackendName(backend));
+        QueensBoardGen_PrepareBackend(board_size, backend);
+    }
+
+    return NULL;
+}
+
+static void* QueensBoardGen_BatchWorker(void* arg)
+{
+    const QueensBoardGen_BatchJob_t* job = (const QueensBoardGen_BatchJob_t*)arg;
+    QueensBoardGen_Batch_t* batch = job->batch;
+
+    /* calling thread runs a job as well, it continues with its own sequence afterwards */
+    const RNG_State_t rng_state = RNG_GetState();
+    RNG_SeedStream(batch->seed, job->stream);
+
+    QueensBoard_Board_t board = { 0 };
+    if (QueensBoard_Create(&board, batch->board_size) == false)
+    {
+        assert(false);
+        atomic_store(&batch->stopped, true);
+        RNG_SetState(rng_state);
+        return NULL;
+    }
+
+    /* workers already take every core, their table scans are not split any further */
+    const uint8 scan_threads = QueensBoardGen_scan_threads;
+    QueensBoardGen_scan_threads = 1u;
+
+    while (QueensBoardGen_BatchGenerateOne(batch, &board) == true)
+    {
+    }
+
+    /* failed generation has freed the board already */
+    if (board.board != NULL)
+    {
+        QueensBoard_Free(&board);
+    }
+
+    QueensBoardGen_scan_threads = scan_threads;
+    RNG_SetState(rng_state);
+
+    return NULL;
+}
+
+/* claims, generates and hands over one board, false if the batch is done. Board is freed (and set to NULL) if generation fails */
+static bool QueensBoardGen_BatchGenerateOne(QueensBoardGen_Batch_t* batch, QueensBoard_Board_t* board)
+{
+    if ((atomic_load_explicit(&batch->stopped, memory_order_relaxed) == true) ||
+        (atomic_fetch_add_explicit(&batch->claimed_count, 1u, memory_order_relaxed) >= batch->boards_count))
+    {
+        return false;
+    }
+
+    uint32 iterations = 0u;
+    if (QueensBoardGen_GenerateUnique(board, 0u, &iterations) != QUEENS_BOARDGEN_SUCCESS)
+    {
+        board->board = NULL;
+        atomic_store(&batch->stopped, true);
+        return false;
+    }
+
+    pthread_mutex_lock(&batch->mutex);
+
+    if (atomic_load(&batch->stopped) == false)
+    {
+        batch->accepted_count++;
+
+        if (batch->callback(batch->context, board) == false)
+        {
+            atomic_store(&batch->stopped, true);
+        }
+    }
+
+    pthread_mutex_unlock(&batch->mutex);
+
+    return true;
+}
+
+/* every uncolored cell may take color of one of its neighbors, cells colored in this pass pass their color on right away. Returns cells uncolored before the pass */
+static uint16 QueensBoardGen_FillPass(QueensBoard_Board_t* board, uint16* const colored_cells_count)
+{
+    uint16 non_color_cells_count = 0u;
+
+    for (uint8 row = 0; row < board->board_size; row++)
+    {
+        for (uint8 column = 0; column < board->board_size; column++)
+        {
+            if (QueensBoard_GetColor(board->board[IDX(row, column, board->board_size)]) == COLOR_NONE)
+            {
+                non_color_cells_count++;
+
+                /* introduce randomness */
+                if (RNG_RandomRange_u32(0, 100) < global_config.boardgen_cell_skip_chance)
+                {
+                    continue;
+                }
+
+                bool only_horizontal = (RNG_RandomRange_u32(0, 100) < global_config.boardgen_only_horizontal_neighbor_chance);
+                bool only_vertical = (RNG_RandomRange_u32(0, 100) < global_config.boardgen_only_vertical_neighbor_chance);
+                int neighbors[4][2] = { 0 };
+                uint8 neighbors_count = QueensBoardGen_GetCellNeighbors(board, row, column, neighbors, only_horizontal, only_vertical);
+
+                for (uint8 i = 0; i < neighbors_count; i++)
+                {
+                    if (RNG_RandomRange_u32(0, 100) < global_config.boardgen_neighbor_skip_chance)
+                    {
+                        continue;
+                    }
+
+                    if (QueensBoard_GetColor(board->board[IDX(neighbors[i][0], neighbors[i][1], board->board_size)]) != COLOR_NONE)
+                    {
+                        QueensBoard_SetColor(&board->board[IDX(row, column, board->board_size)], QueensBoard_GetColor(board->board[IDX(neighbors[i][0], neighbors[i][1], board->board_size)]));
+                        (*colored_cells_count)++;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    return non_color_cells_count;
+}
+
+static void QueensBoardGen_RegionsInit(QueensBoardGen_Regions_t* regions, const QueensBoard_Board_t* board)
+{
+    memset(regions, 0, sizeof(QueensBoardGen_Regions_t));
+    regions->board_size = board->board_size;
+
+    for (uint8 row = 0u; row < board->board_size; row++)
+    {
+        for (uint8 column = 0u; column < board->board_size; column++)
+        {
+            const uint16 bit = (uint16)(1u << column);
+            const QueensBoard_Cell_t color = QueensBoard_GetColor(board->board[IDX(row, column, board->board_size)]);
+
+            if (color == COLOR_NONE)
+            {
+                regions->uncolored.rows[row] |= bit;
+            }
+            else
+            {
+                regions->colors[color].rows[row] |= bit;
+            }
+        }
+    }
+}
+
+/*
+    bit-parallel counterpart of QueensBoardGen_FillPass, every random decision of the scalar pass is a mask drawn for all cells at once.
+    Rows are resolved top to bottom like in the scalar pass: row above is already updated, row below is not.
+    Within a row cells taking color of left neighbor continue whatever their left neighbor got in this pass, resolved by prefix spread.
+    Returns cells uncolored before the pass
+*/
+static uint16 QueensBoardGen_GrowRegions(QueensBoardGen_Regions_t* regions, QueensBoard_Board_t* board, uint16* const colored_cells_count)
+{
+    const uint8 board_size = regions->board_size;
+    const uint16 cell_keep_probability = (uint16)(QUEENS_BOARDGEN_MASK_PROBABILITY_ONE - QueensBoardGen_GetMaskProbability(global_config.boardgen_cell_skip_chance));
+    const uint16 neighbor_keep_probability = (uint16)(QUEENS_BOARDGEN_MASK_PROBABILITY_ONE - QueensBoardGen_GetMaskProbability(global_config.boardgen_neighbor_skip_chance));
+
+    const QueensBoardGen_Plane_t growing = QueensBoardGen_RandomPlane(&regions->uncolored, cell_keep_probability);
+    const QueensBoardGen_Plane_t only_horizontal = QueensBoardGen_RandomPlane(&growing, QueensBoardGen_GetMaskProbability(global_config.boardgen_only_horizontal_neighbor_chance));
+    const QueensBoardGen_Plane_t only_vertical = QueensBoardGen_RandomPlane(&growing, QueensBoardGen_GetMaskProbability(global_config.boardgen_only_vertical_neighbor_chance));
+    const QueensBoardGen_Plane_t keep_up = QueensBoardGen_RandomPlane(&growing, neighbor_keep_probability);
+    const QueensBoardGen_Plane_t keep_down = QueensBoardGen_RandomPlane(&growing, neighbor_keep_probability);
+    const QueensBoardGen_Plane_t keep_left = QueensBoardGen_RandomPlane(&growing, neighbor_keep_probability);
+    const QueensBoardGen_Plane_t keep_right = QueensBoardGen_RandomPlane(&growing, neighbor_keep_probability);
+
+    const uint16 inside = (uint16)((1u << board_size) - 1u);
+    uint16 uncolored_count = 0u;
+    *colored_cells_count = 0u;
+
+    for (uint8 row = 0u; row < board_size; row++)
+    {
+        const uint16 uncolored = regions->uncolored.rows[row];
+        uncolored_count = (uint16)(uncolored_count + __builtin_popcount(uncolored));
+
+        if (growing.rows[row] == 0u)
+        {
+            continue;
+        }
+
+        const uint16 colored = (uint16)(inside & ~uncolored);
+        const uint16 colored_above = (row > 0u) ? (uint16)(inside & ~regions->uncolored.rows[row - 1u]) : 0u;
+        const uint16 colored_below = (row < (board_size - 1u)) ? (uint16)(inside & ~regions->uncolored.rows[row + 1u]) : 0u;
+
+        /* neighbors are tried up, down, left, right, only horizontal ones leave out up and down, only vertical ones left and right */
+        const uint16 vertical = (uint16)(growing.rows[row] & ~only_horizontal.rows[row]);
+        const uint16 horizontal = (uint16)(growing.rows[row] & ~only_vertical.rows[row]);
+        const uint16 takes_up = (uint16)(vertical & keep_up.rows[row] & colored_above);
+        const uint16 takes_down = (uint16)(vertical & keep_down.rows[row] & colored_below & ~takes_up);
+        const uint16 left_or_right = (uint16)(horizontal & ~takes_up & ~takes_down);
+        const uint16 left_candidates = (uint16)(left_or_right & keep_left.rows[row]);
+        const uint16 right_candidates = (uint16)(left_or_right & keep_right.rows[row] & (colored >> 1u));
+
+        /* cell colored either way is a colored left neighbor for the next one */
+        const uint16 colored_after = QueensBoardGen_SpreadRight((uint16)(colored | takes_up | takes_down | right_candidates), left_candidates);
+        const uint16 takes_left = (uint16)(left_candidates & (colored_after << 1u));
+        const uint16 takes_right = (uint16)(right_candidates & ~takes_left);
+
+        if ((takes_up | takes_down | takes_left | takes_right) == 0u)
+        {
+            continue;
+        }
+
+        for (uint8 color = 1u; color <= board_size; color++)
+        {
+            uint16* const color_row = &regions->colors[color].rows[row];
+            const uint16 above = (row > 0u) ? regions->colors[color].rows[row - 1u] : 0u;
+            const uint16 below = (row < (board_size - 1u)) ? regions->colors[color].rows[row + 1u] : 0u;
+
+            const uint16 grown = (uint16)(QueensBoardGen_SpreadRight((uint16)(*color_row | (takes_up & above) | (takes_down & below) | (takes_right & (*color_row >> 1u))), takes_left) & ~*color_row);
+
+            *color_row |= grown;
+
+            /* only newly colored cells are written to the board */
+            for (uint16 bits = grown; bits != 0u; bits &= (uint16)(bits - 1u))
+            {
+                QueensBoard_SetColor(&board->board[IDX(row, __builtin_ctz(bits), board_size)], color);
+            }
+        }
+
+        const uint16 colored_now = (uint16)(takes_up | takes_down | takes_left | takes_right);
+        regions->uncolored.rows[row] &= (uint16)~colored_now;
+        *colored_cells_count = (uint16)(*colored_cells_count + __builtin_popcount(colored_now));
+    }
+
+    return uncolored_count;
+}
+
+/* region growth draws random masks for every word with uncolored cells, cell by cell pass draws only for uncolored cells (but several numbers for each) */
+static bool QueensBoardGen_IsGrowthCheaper(const QueensBoardGen_Regions_t* regions)
+{
+    uint16 growth_cost = 0u;
+    uint16 fill_pass_cost = 0u;
+
+    for (uint8 word_idx = 0u; word_idx < QUEENS_BOARDGEN_PLANE_WORDS; word_idx++)
+    {
+        if (regions->uncolored.words[word_idx] != 0u)
+        {
+            growth_cost = (uint16)(growth_cost + QUEENS_BOARDGEN_GROWTH_MASKS * QUEENS_BOARDGEN_MASK_DRAWS);
+            fill_pass_cost = (uint16)(fill_pass_cost + QUEENS_BOARDGEN_FILL_PASS_CELL_COST * __builtin_popcount(regions->uncolored.words[word_idx]));
+        }
+    }
+
+    return growth_cost < fill_pass_cost;
+}
+
+/* cells plus every cell of through reached from them going right through cells of through only, in log steps like carry lookahead */
+static uint16 QueensBoardGen_SpreadRight(const uint16 cells, const uint16 through)
+{
+    uint16 spread = cells;
+    uint16 path = through;
+
+    spread |= (uint16)(path & (spread << 1u));
+    path &= (uint16)(path << 1u);
+    spread |= (uint16)(path & (spread << 2u));
+    path &= (uint16)(path << 2u);
+    spread |= (uint16)(path & (spread << 4u));
+    path &= (uint16)(path << 4u);
+    spread |= (uint16)(path & (spread << 8u));
+
+    return spread;
+}
+
+/*
+    bits set with probability / 256, only in words where needed has any bit (others are left clear).
+    Random words are combined from the lowest probability bit up: OR for 1, AND for 0
+*/
+static QueensBoardGen_Plane_t QueensBoardGen_RandomPlane(const QueensBoardGen_Plane_t* needed, const uint16 probability)
+{
+    QueensBoardGen_Plane_t plane = { 0 };
+
+    for (uint8 word_idx = 0u; word_idx < QUEENS_BOARDGEN_PLANE_WORDS; word_idx++)
+    {
+        if ((needed->words[word_idx] == 0u) ||
+            (probability == 0u))
+        {
+            continue;
+        }
+
+        if (probability >= QUEENS_BOARDGEN_MASK_PROBABILITY_ONE)
+        {
+            plane.words[word_idx] = needed->words[word_idx];
+            continue;
+        }
+
+        uint32 word = 0u;
+        for (uint8 bit = (uint8)__builtin_ctz(probability); bit < QUEENS_BOARDGEN_MASK_DRAWS; bit++)
+        {
+            word = (((probability >> bit) & 1u) != 0u) ? (word | RNG_Random_u32()) : (word & RNG_Random_u32());
+        }
+
+        plane.words[word_idx] = word & needed->words[word_idx];
+    }
+
+    return plane;
+}
+
+/* chance out of QUEENS_BOARDGEN_CHANCE_RANGE as mask probability out of 256 */
+static uint16 QueensBoardGen_GetMaskProbability(const uint8 chance)
+{
+    const uint32 capped_chance = (chance < QUEENS_BOARDGEN_CHANCE_RANGE) ? chance : QUEENS_BOARDGEN_CHANCE_RANGE;
+
+    return (uint16)((capped_chance * QUEENS_BOARDGEN_MASK_PROBABILITY_ONE + (QUEENS_BOARDGEN_CHANCE_RANGE / 2u)) / QUEENS_BOARDGEN_CHANCE_RANGE);
+}
+
+/*
+    other solutions are broken one by one by recoloring a cell under one of their queens, false if some are left after all allowed edits.
+    Only queens on colored cells count, so partially colored board is left without a second solution that would survive the rest of coloring
+*/
+static bool QueensBoardGen_Repair(QueensBoard_Board_t* board, const QueensPermutations_QueenRowIndex_t* const planted)
+{
+    QueensPermutations_QueenRowIndex_t other[QUEENS_MAX_BOARD_SIZE];
+
+    for (uint8 edits_count = 0u; ; edits_count++)
+    {
+        if (QueensBoardGen_FindOtherSolution(board, planted, other) == false)
+        {
+            return true;
+        }
+
+        if ((edits_count == QUEENS_BOARDGEN_REPAIR_MAX_EDITS) ||
+            (QueensBoardGen_RecolorQueenCell(board, planted, other) == false))
+        {
+            return false;
+        }
+    }
+}
+
+/*
+    cell under a queen of other solution (not under a planted one) takes color of a neighboring region, other solution then has that color twice.
+    Region the cell leaves has to stay connected, planted queens keep their cells and colors
+*/
+static bool QueensBoardGen_RecolorQueenCell(QueensBoard_Board_t* board, const QueensPermutations_QueenRowIndex_t* const planted, const QueensPermutations_QueenRowIndex_t* const other)
+{
+    const uint8 board_size = board->board_size;
+    const uint8 first_column = (uint8)RNG_RandomRange_u32(0u, board_size - 1u);
+
+    for (uint8 column_idx = 0u; column_idx < board_size; column_idx++)
+    {
+        const uint8 column = (uint8)((first_column + column_idx) % board_size);
+        const uint8 row = (uint8)other[column];
+
+        if (planted[column] == other[column])
+        {
+            continue;
+        }
+
+        QueensBoard_Cell_t* cell = &board->board[IDX(row, column, board_size)];
+        const QueensBoard_Cell_t color = QueensBoard_GetColor(*cell);
+        int neighbors[4][2] = { 0 };
+        const uint8 neighbors_count = QueensBoardGen_GetCellNeighbors(board, row, column, neighbors, false, false);
+
+        for (uint8 i = 0u; i < neighbors_count; i++)
+        {
+            const QueensBoard_Cell_t neighbor_color = QueensBoard_GetColor(board->board[IDX(neighbors[i][0], neighbors[i][1], board_size)]);
+
+            if ((neighbor_color != color) &&
+                (neighbor_color != COLOR_NONE) &&
+                (QueensBoardGen_IsRegionConnectedWithout(board, planted, row, column) == true))
+            {
+                QueensBoard_SetColor(cell, neighbor_color);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/* region of given cell stays in one piece without it, flood fill from its planted queen reaches all other cells of the region */
+static bool QueensBoardGen_IsRegionConnectedWithout(const QueensBoard_Board_t* board, const QueensPermutations_QueenRowIndex_t* const planted, const uint8 row, const uint8 column)
+{
+    const uint8 board_size = board->board_size;
+    const QueensBoard_Cell_t color = QueensBoard_GetColor(board->board[IDX(row, column, board_size)]);
+
+    /* region of color C is grown from planted queen of column C - 1 */
+    const uint8 planted_column = (uint8)(color - 1u);
+    const uint8 planted_row = (uint8)planted[planted_column];
+
+    bool visited[QUEENS_MAX_BOARD_SIZE * QUEENS_MAX_BOARD_SIZE] = { false };
+    uint8 stack[QUEENS_MAX_BOARD_SIZE * QUEENS_MAX_BOARD_SIZE][2];
+    uint16 stack_size = 0u;
+    uint16 reached_count = 0u;
+    uint16 region_size = 0u;
+
+    for (uint16 cell_idx = 0u; cell_idx < (uint16)(board_size * board_size); cell_idx++)
+    {
+        if (QueensBoard_GetColor(board->board[cell_idx]) == color)
+        {
+            region_size++;
+        }
+    }
+
+    visited[IDX(row, column, board_size)] = true;
+    visited[IDX(planted_row, planted_column, board_size)] = true;
+    stack[stack_size][0] = planted_row;
+    stack[stack_size][1] = planted_column;
+    stack_size++;
+
+    while (stack_size > 0u)
+    {
+        stack_size--;
+        reached_count++;
+
+        int neighbors[4][2] = { 0 };
+        const uint8 neighbors_count = QueensBoardGen_GetCellNeighbors(board, stack[stack_size][0], stack[stack_size][1], neighbors, false, false);
+
+        for (uint8 i = 0u; i < neighbors_count; i++)
+        {
+            const uint16 neighbor_idx = (uint16)IDX(neighbors[i][0], neighbors[i][1], board_size);
+
+            if ((visited[neighbor_idx] == false) &&
+                (QueensBoard_GetColor(board->board[neighbor_idx]) == color))
+            {
+                visited[neighbor_idx] = true;
+                stack[stack_size][0] = (uint8)neighbors[i][0];
+                stack[stack_size][1] = (uint8)neighbors[i][1];
+                stack_size++;
+            }
+        }
+    }
+
+    /* every cell of the region but the removed one */
+    return (reached_count + 1u == region_size);
+}
+
+static bool QueensBoardGen_FindOtherSolution(const QueensBoard_Board_t* board, const QueensPermutations_QueenRowIndex_t* const planted, QueensPermutations_QueenRowIndex_t* const other)
+{
+    QueensBoardGen_OtherSearch_t search = {
+        .board = board,
+        .planted = planted,
+        .rows = other,
+        .all_rows = (uint16)((1u << board->board_size) - 1u)
+    };
+
+    QueensBoardGen_FindOtherColumn(&search, 0u, 0u, 0u, false);
+
+    return search.found;
+}
+
+static void QueensBoardGen_FindOtherColumn(QueensBoardGen_OtherSearch_t* search, const uint8 column, const uint16 used_rows, const uint32 used_colors, const bool differs)
+{
+    const uint8 board_size = search->board->board_size;
+
+    if (column == board_size)
+    {
+        search->found = differs;
+        return;
+    }
+
+    uint16 rows = (uint16)(search->all_rows & ~used_rows);
+
+    /* queens in adjacent columns can't be in adjacent rows */
+    if (column > 0u)
+    {
+        const uint32 previous_row_bit = 1u << search->rows[column - 1u];
+        rows &= (uint16)~((previous_row_bit << 1u) | (previous_row_bit >> 1u));
+    }
+
+    for (; (rows != 0u) && (search->found == false); rows &= (uint16)(rows - 1u))
+    {
+        const uint8 row = (uint8)__builtin_ctz(rows);
+        const QueensBoard_Cell_t color = QueensBoard_GetColor(search->board->board[IDX(row, column, board_size)]);
+        const uint32 color_bit = 1u << color;
+
+        if ((color != COLOR_NONE) &&
+            ((used_colors & color_bit) == 0u))
+        {
+            search->rows[column] = (QueensPermutations_QueenRowIndex_t)row;
+            QueensBoardGen_FindOtherColumn(search, column + 1u, (uint16)(used_rows | (1u << row)), used_colors | color_bit, (differs == true) || (row != search->planted[column]));
+        }
+    }
+}
+
+/* every cell has one of colors 1..board_size */
+static bool QueensBoardGen_IsFullyColored(const QueensBoard_Board_t* board)
+{
+    const uint16 cells_count = (uint16)(board->board_size * board->board_size);
+
+    for (uint16 cell_idx = 0u; cell_idx < cells_count; cell_idx++)
+    {
+        const uint8 color = QueensBoard_GetColor(board->board[cell_idx]);
+        if ((color == COLOR_NONE) || (color > board->board_size))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+    queens on colored cells only: second solution there survives any coloring of the rest.
+    Uncolored cells as wildcards: nothing but the planted solution means no coloring of the rest can add one
+*/
+static QueensBoardGen_Uniqueness_t QueensBoardGen_CheckPartial(const QueensBoard_Board_t* board)
+{
+    if (QueensBoardGen_MemoSolutions(board, 2u, false) >= 2u)
+    {
+        return QUEENS_BOARDGEN_UNIQUENESS_NOT_UNIQUE;
+    }
+
+    if (QueensBoardGen_MemoSolutions(board, 2u, true) == 1u)
+    {
+        return QUEENS_BOARDGEN_UNIQUENESS_UNIQUE;
+    }
+
+    return QUEENS_BOARDGEN_UNIQUENESS_UNKNOWN;
+}
+
+static uint32 QueensBoardGen_MemoSolutions(const QueensBoard_Board_t* board, const uint32 max_solutions, const bool uncolored_allowed)
+{
+    const uint8 board_size = board->board_size;
+    QueensBoardGen_Memo_t memo = {
+        .board = board,
+        .all_rows = (uint16)((1u << board_size) - 1u),
+        .max_solutions = max_solutions,
+        .uncolored_allowed = uncolored_allowed
+    };
+
+    for (uint8 column = board_size; column-- > 0u;)
+    {
+        memo.remaining_colors[column] = memo.remaining_colors[column + 1u];
+
+        for (uint8 row = 0u; row < board_size; row++)
+        {
+            const QueensBoard_Cell_t color = QueensBoard_GetColor(board->board[IDX(row, column, board_size)]);
+            memo.remaining_colors[column] |= (color != COLOR_NONE) ? (1u << color) : 0u;
+        }
+    }
+
+    memo.all_colors = memo.remaining_colors[0];
+
+    /* every color has to have its queen, unless uncolored cells may stand in for missing ones */
+    if ((uncolored_allowed == false) &&
+        ((uint32)__builtin_popcount(memo.all_colors) != board_size))
+    {
+        return 0u;
+    }
+
+    if (++QueensBoardGen_memo_generation == 0u)
+    {
+        memset(QueensBoardGen_memo, 0, sizeof(QueensBoardGen_memo));
+        QueensBoardGen_memo_generation = 1u;
+    }
+
+    memo.generation = QueensBoardGen_memo_generation;
+
+    return QueensBoardGen_MemoColumn(&memo, 0u, 0u, 0u, QUEEN_ROW_NOT_EXISTS);
+}
+
+static uint32 QueensBoardGen_MemoColumn(const QueensBoardGen_Memo_t* memo, const uint8 column, const uint16 used_rows, const uint32 used_colors, const sint8 previous_row)
+{
+    const uint8 board_size = memo->board->board_size;
+
+    if (column == board_size)
+    {
+        return 1u;
+    }
+
+    /* color missing in all remaining columns can't get its queen anymore */
+    if ((memo->uncolored_allowed == false) &&
+        ((memo->all_colors & ~used_colors & ~memo->remaining_colors[column]) != 0u))
+    {
+        return 0u;
+    }
+
+    QueensBoardGen_MemoEntry_t* entry = NULL;
+    const bool memoised = ((board_size - column) >= QUEENS_BOARDGEN_MEMO_MIN_COLUMNS_LEFT) && (column > 0u);
+    const uint64 state = ((uint64)(uint8)previous_row << 32u) | ((uint64)used_colors << QUEENS_MAX_BOARD_SIZE) | used_rows;
+
+    if (memoised == true)
+    {
+        const uint32 slot = (uint32)((state * 0x9E3779B97F4A7C15ull) >> 40u);
+
+        for (uint8 probe = 0u; probe < QUEENS_BOARDGEN_MEMO_PROBES; probe++)
+        {
+            QueensBoardGen_MemoEntry_t* candidate = &QueensBoardGen_memo[(slot + probe) & (QUEENS_BOARDGEN_MEMO_SIZE - 1u)];
+
+            if (candidate->generation != memo->generation)
+            {
+                entry = (entry == NULL) ? candidate : entry;
+                continue;
+            }
+
+            if (candidate->state == state)
+            {
+                return candidate->solutions_count;
+            }
+        }
+
+        /* all probed slots taken by other states of this validation, first one gives way */
+        entry = (entry == NULL) ? &QueensBoardGen_memo[slot & (QUEENS_BOARDGEN_MEMO_SIZE - 1u)] : entry;
+    }
+
+    uint16 rows = (uint16)(memo->all_rows & ~used_rows);
+
+    /* queens in adjacent columns can't be in adjacent rows */
+    if (previous_row != QUEEN_ROW_NOT_EXISTS)
+    {
+        const uint32 previous_row_bit = 1u << previous_row;
+        rows &= (uint16)~((previous_row_bit << 1u) | (previous_row_bit >> 1u));
+    }
+
+    uint32 solutions_count = 0u;
+
+    for (; (rows != 0u) && (solutions_count < memo->max_solutions); rows &= (uint16)(rows - 1u))
+    {
+        const uint8 row = (uint8)__builtin_ctz(rows);
+        const QueensBoard_Cell_t color = QueensBoard_GetColor(memo->board->board[IDX(row, column, board_size)]);
+
+        if ((color == COLOR_NONE) &&
+            (memo->uncolored_allowed == false))
+        {
+            continue;
+        }
+
+        const uint32 color_bit = (color != COLOR_NONE) ? (1u << color) : 0u;
+
+        if ((used_colors & color_bit) == 0u)
+        {
+            solutions_count += QueensBoardGen_MemoColumn(memo, column + 1u, (uint16)(used_rows | (1u << row)), used_colors | color_bit, (sint8)row);
+        }
+    }
+
+    /* more than max_solutions is as good as max_solutions, search stopped early in such case */
+    solutions_count = (solutions_count < memo->max_solutions) ? solutions_count : memo->max_solutions;
+
+    if (entry != NULL)
+    {
+        *entry = (QueensBoardGen_MemoEntry_t){ .state = state, .generation = memo->generation, .solutions_count = solutions_count };
+    }
+
+    return solutions_count;
+}
+
+static QueensPermutations_Visit_t QueensBoardGen_VisitTreePrefix(void* context, const uint8 column, const QueensPermutations_QueenRowIndex_t row)
+{
+    QueensBoardGen_TreeSearch_t* search = context;
+    const uint8 color = QueensBoard_GetColor(search->board->board[IDX(row, column, search->board->board_size)]);
+    const uint32 color_bit = 1u << color;
+
+    if ((search->used_colors[column] & color_bit) != 0u)
+    {
+        return QUEENS_PERMUTATIONS_VISIT_SKIP;
+    }
+
+    search->used_colors[column + 1u] = search->used_colors[column] | color_bit;
+
+    if ((column + 1u) == search->board->board_size)
+    {
+        search->solutions_count++;
+        if (search->solutions_count >= search->max_solutions)
+        {
+            return QUEENS_PERMUTATIONS_VISIT_STOP;
+        }
+    }
 
-    return one_solution;
+    return QUEENS_PERMUTATIONS_VISIT_DESCEND;
 }
 
 static uint8 QueensBoardGen_GetCellNeighbors(const QueensBoard_Board_t* board, const uint8 row, const uint8 column, int neighbors[4][2], bool only_horizontal, bool only_vertical)
@@ -5,9 +5,22 @@
 #include <debug_print.h>
 #include <global_config.h>
 #include <rng.h>
-
-/* estimated empirically */
-constexpr uint32 BOARDS_INIT_MALLOC_FACTOR = 500u;
+#include <crc.h>
+#include <nibble.h>
+#include <thread_pool.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <limits.h>
+#include <glob.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+/* packed payload size from which loaded table is unpacked by multiple threads */
+constexpr uint64 QUEENS_PERMUTATIONS_PARALLEL_UNPACK_MIN_SIZE = 8u * 1024u * 1024u;
 
 const char* QueensPermutations_filename = "QueensPermutations_XXX.bin";
 constexpr uint8 QueensPermutations_filename_strlen = 27u;
@@ -15,449 +28,3288 @@ constexpr uint8 QueensPermutations_filename_first_X_pos = 19u;
 constexpr uint8 QueensPermutations_filename_second_X_pos = 20u;
 constexpr uint8 QueensPermutations_filename_third_X_pos = 21u;
 
-static QueensPermutations_Result_t QueensPermutations_Generate(const QueensPermutation_BoardSize_t board_size);
-static bool QueensPermutations_IsQueenPlacementLegal(const QueensPermutations_QueenRowIndex_t* const board, const QueensPermutation_BoardSize_t board_size, const sint8 dest_column, const sint8 dest_row);
+/* symmetries of the square, symmetry index bits: bit 0 - reverse columns, bit 1 - flip rows, bit 2 - transpose (applied in that order) */
+constexpr uint8 QUEENS_PERMUTATIONS_SYMMETRIES_COUNT = 8u;
+/* symmetric file record: canonical board followed by orbit code (bit N set - symmetry N yields new board of the orbit) */
+constexpr uint8 QUEENS_PERMUTATIONS_ORBIT_CODE_NIBBLES = 2u;
+/* records read at once by cursor, each expands to at most 8 boards */
+constexpr uint32 QUEENS_PERMUTATIONS_CURSOR_BATCH_RECORDS = QUEENS_PERMUTATIONS_CURSOR_BATCH_SIZE / QUEENS_PERMUTATIONS_SYMMETRIES_COUNT;
+
+/* permutations file: header | payload | CRC16 of every payload block */
+constexpr uint32 QUEENS_PERMUTATIONS_FILE_MAGIC = 0x4D525051u; /* "QPRM" */
+constexpr uint16 QUEENS_PERMUTATIONS_FILE_VERSION = 1u;
+constexpr uint32 QUEENS_PERMUTATIONS_FILE_BLOCK_SIZE = 65536u;
+
+typedef enum
+{
+    QUEENS_PERMUTATIONS_ENCODING_RAW = 0,       /* one byte per column */
+    QUEENS_PERMUTATIONS_ENCODING_NIBBLE = 1,    /* one nibble per column */
+    QUEENS_PERMUTATIONS_ENCODING_SYMMETRIC = 2, /* nibble-packed canonical boards with orbit codes */
+    QUEENS_PERMUTATIONS_ENCODING_TREE = 3       /* prefix tree bit stream, see QueensPermutations_TreeWalker_t */
+} QueensPermutations_Encoding_t;
+
+typedef struct
+{
+    uint32 magic;
+    uint16 version;
+    uint8 board_size;
+    uint8 encoding;        /* QueensPermutations_Encoding_t */
+    uint64 boards_count;   /* full set of permutations */
+    uint64 records_count;  /* records stored in payload, differs from boards_count only for symmetric encoding */
+    uint64 payload_size;   /* in bytes */
+    uint32 block_size;
+    uint16 header_crc;     /* CRC of the header with this field zeroed */
+    uint16 reserved;
+} QueensPermutations_FileHeader_t;
+
+static_assert(sizeof(QueensPermutations_FileHeader_t) == 40u);
+
+/* sharded store manifest: header | entry per non-empty shard, shards themselves are regular permutations files */
+static const char* const QUEENS_PERMUTATIONS_SHARD_EXTENSION = ".bin";
+/* checkpoint parts of the cached file being built, same format as shards, removed once the file is complete */
+static const char* const QUEENS_PERMUTATIONS_PART_EXTENSION = ".part";
+constexpr uint32 QUEENS_PERMUTATIONS_MANIFEST_MAGIC = 0x4D535051u; /* "QPSM" */
+constexpr uint16 QUEENS_PERMUTATIONS_MANIFEST_VERSION = 1u;
+
+typedef struct
+{
+    uint32 magic;
+    uint16 version;
+    uint8 board_size;
+    uint8 encoding;        /* of shard files */
+    uint32 shards_count;
+    uint16 crc;            /* CRC of the header with this field zeroed, followed by all entries */
+    uint16 reserved;
+    uint64 boards_count;   /* all shards together */
+} QueensPermutations_ManifestHeader_t;
+
+static_assert(sizeof(QueensPermutations_ManifestHeader_t) == 24u);
+
+typedef struct
+{
+    uint64 boards_count;
+    QueensPermutations_QueenRowIndex_t prefix[QUEENS_PERMUTATIONS_SHARD_PREFIX_LEN];
+    uint8 reserved[8u - QUEENS_PERMUTATIONS_SHARD_PREFIX_LEN];
+} QueensPermutations_ManifestEntry_t;
+
+static_assert(sizeof(QueensPermutations_ManifestEntry_t) == 16u);
+
+/* CRC of consecutive payload blocks, either computed (write) or compared against the ones stored in file (read) */
+typedef struct
+{
+    uint16* block_crcs;
+    uint64 blocks_count;
+    uint64 blocks_capacity;
+    uint64 block_idx;
+    uint32 block_fill;     /* bytes of current block already processed */
+    uint16 crc;
+    bool verify;
+} QueensPermutations_BlockCrc_t;
+
+typedef struct
+{
+    FILE* file;                                  /* temporary file, renamed to filename once complete */
+    char filename[PATH_MAX];
+    char temp_filename[PATH_MAX];
+    QueensPermutations_FileHeader_t header;
+    QueensPermutations_BlockCrc_t block_crc;
+    uint8 buffer[128];
+    size_t buffer_idx;
+    bool lower_nibble;
+    bool write_failed;                           /* some write was short (e.g. disk full), file is not published */
+} QueensPermutations_FileWriter_t;
+
+/*
+    prefix tree is stored depth-first, every node (prefix of given length) is followed by subtrees of its children in ascending row order.
+    Node stores one bit per admissible row of next column (row not used yet and not adjacent to the previous one), most significant bit first,
+    set if that row leads to at least one permutation. Nodes with single admissible row store nothing, leaves (complete boards) are implicit
+*/
+constexpr uint8 QUEENS_PERMUTATIONS_TREE_INDEX_DEPTH = 4u; /* depth of nodes indexed for random access */
+constexpr uint8 QUEENS_PERMUTATIONS_TREE_LOOKAHEAD_BYTES = 32u; /* stream bytes cursor keeps ahead of the walker */
+
+typedef struct
+{
+    uint8* stream;
+    uint64 bits_count;
+    size_t capacity;       /* in bytes */
+    QueensPermutation_BoardSize_t board_size;
+    bool failed;
+} QueensPermutations_TreeBuilder_t;
+
+typedef struct
+{
+    const uint8* stream;
+    size_t stream_size;                          /* in bytes, bits past the end read as zeroes */
+    uint64 bit_pos;
+    QueensPermutations_QueenRowIndex_t board[QUEENS_MAX_BOARD_SIZE];
+    uint16 used_rows[QUEENS_MAX_BOARD_SIZE + 1]; /* rows used by columns before given one */
+    uint16 children[QUEENS_MAX_BOARD_SIZE];      /* child rows of node at given depth still to be visited */
+    QueensPermutation_BoardSize_t board_size;
+    uint8 root_depth;                            /* walker stops once subtree of this node is exhausted */
+    uint8 depth;
+} QueensPermutations_TreeWalker_t;
+
+/* node at QUEENS_PERMUTATIONS_TREE_INDEX_DEPTH, lets random access start walking close to requested board */
+typedef struct
+{
+    uint64 first_board;                          /* number of boards before this node's subtree */
+    uint64 bit_pos;                              /* start of the node in the stream */
+    QueensPermutations_QueenRowIndex_t prefix[QUEENS_PERMUTATIONS_TREE_INDEX_DEPTH];
+} QueensPermutations_TreeIndexEntry_t;
+
+/* depth-first enumerator state, rows are tracked as bitmasks (bit N - row N) */
+typedef struct
+{
+    QueensPermutations_QueenRowIndex_t board[QUEENS_MAX_BOARD_SIZE];
+    uint16 used_rows[QUEENS_MAX_BOARD_SIZE + 1]; /* rows used by columns before given one */
+    uint16 candidates[QUEENS_MAX_BOARD_SIZE];    /* rows still to be tried in given column */
+    QueensPermutation_BoardSize_t board_size;
+    uint8 prefix_len;                            /* number of leading columns fixed by the caller */
+    uint8 column;
+} QueensPermutations_Enumerator_t;
+
+struct QueensPermutations_Cursor
+{
+    QueensPermutations_Enumerator_t enumerator;
+    QueensPermutations_QueenRowIndex_t* boards;  /* current batch, always unpacked */
+    uint8* file_buffer;                          /* packed batch read from file */
+    FILE* file;                                  /* NULL if permutations come from enumerator */
+    QueensPermutations_BlockCrc_t block_crc;     /* payload is verified as it is streamed */
+    uint64 file_boards_left;                     /* records left for symmetric file */
+    QueensPermutation_BoardSize_t board_size;
+    bool file_packed;
+    bool file_symmetric;
+    bool file_tree;                              /* file_boards_left counts payload bytes left for prefix tree */
+    QueensPermutations_TreeWalker_t tree_walker; /* walks file_buffer window for prefix tree */
+    bool failed;                                 /* payload didn't match its checksums, batches read so far can't be trusted */
+};
+
+struct QueensPermutations_Source
+{
+    QueensPermutations_FileHeader_t header;
+    FILE* file;                                  /* records are read with pread, NULL if file is mapped */
+    const uint8* mapping;                        /* header and payload mapped read-only, NULL if file is read */
+    size_t mapping_size;
+    const uint8* tree;                           /* prefix tree stream, either mapped or read into heap */
+    QueensPermutations_TreeIndexEntry_t* tree_index;
+    uint32 tree_index_count;
+    uint64* completion_counts;                   /* no file at all, see QueensPermutations_SourceOpenCompletionCounts */
+    QueensPermutations_Shards_t* shards;         /* sharded store, every shard has its own source */
+    QueensPermutations_Source_t** shard_sources;
+    QueensPermutation_BoardSize_t board_size;
+};
+
+struct QueensPermutations_Shards
+{
+    QueensPermutations_ManifestHeader_t header;
+    QueensPermutations_ManifestEntry_t* entries;
+    uint64* first_boards;                        /* boards in shards before given one, for choice weighted by count */
+    QueensPermutation_BoardSize_t board_size;
+};
+
+/* shards (and checkpoint parts) are built in parallel, one prefix at a time per thread */
+typedef struct
+{
+    QueensPermutations_ManifestEntry_t* entries; /* prefixes of files to build, counts are filled in */
+    uint32 entries_count;
+    const char* extension;                       /* of built files, see QueensPermutations_GetShardFilename */
+    atomic_uint next_entry;
+    atomic_bool failed;
+    QueensPermutation_BoardSize_t board_size;
+} QueensPermutations_ShardsJob_t;
+
+typedef struct
+{
+    QueensPermutations_QueenRowIndex_t* boards;           /* table of all first rows, slices are in first row order */
+    uint64 first_row_offsets[QUEENS_MAX_BOARD_SIZE + 1u]; /* boards before the slice of given row of the queen in column 0 */
+    atomic_uint next_first_row;
+    atomic_bool failed;
+    QueensPermutation_BoardSize_t board_size;
+} QueensPermutations_GenerateJob_t;
+
+static bool QueensPermutations_GenerateFromFirstRow(const QueensPermutation_BoardSize_t board_size, const sint8 first_row, QueensPermutations_QueenRowIndex_t* const boards, const uint64 boards_count);
+static void* QueensPermutations_GenerateWorker(void* arg);
+static void QueensPermutations_EnumeratorInit(QueensPermutations_Enumerator_t* enumerator, const QueensPermutation_BoardSize_t board_size, const QueensPermutations_QueenRowIndex_t* const prefix, const uint8 prefix_len);
+static bool QueensPermutations_EnumeratorNext(QueensPermutations_Enumerator_t* enumerator, QueensPermutations_QueenRowIndex_t* const board);
 static bool QueensPermutations_SaveToFile(const QueensPermutations_Result_t* const result);
-static QueensPermutations_Result_t QueensPermutations_LoadAllFromFile(const QueensPermutation_BoardSize_t board_size);
-static void QueensPermutations_Decompress(QueensPermutations_Result_t* result);
-static inline uint32 QueensPermutations_RoundUpDiv(uint32 num, uint32 div);
-static FILE* QueensPermutations_OpenPermutationsFile(QueensPermutation_BoardSize_t board_size, const char* mode);
+static bool QueensPermutations_SaveEnumeratedToFile(const QueensPermutation_BoardSize_t board_size, const QueensPermutations_QueenRowIndex_t* const prefix, const uint8 prefix_len, const char* const filename, uint64* const boards_count);
+static QueensPermutations_Source_t* QueensPermutations_SourceOpenFile(FILE* file, const QueensPermutations_FileHeader_t* const header, const QueensPermutation_BoardSize_t board_size);
+static QueensPermutations_Source_t* QueensPermutations_SourceOpenShards(const QueensPermutation_BoardSize_t board_size);
+static bool QueensPermutations_SourceGetRandomSharded(const QueensPermutations_Source_t* const source, QueensPermutations_QueenRowIndex_t* const board);
+static bool QueensPermutations_IsSharded(void);
+static bool QueensPermutations_BuildShards(const QueensPermutation_BoardSize_t board_size);
+static bool QueensPermutations_SaveCheckpointedToFile(const QueensPermutation_BoardSize_t board_size);
+static void QueensPermutations_RemoveMatchingFiles(const char* const pattern);
+static bool QueensPermutations_RunPrefixJob(QueensPermutations_ShardsJob_t* job);
+static void* QueensPermutations_BuildShardsWorker(void* arg);
+static bool QueensPermutations_SaveManifest(const QueensPermutation_BoardSize_t board_size, const QueensPermutations_ManifestEntry_t* const entries, const uint32 entries_count);
+static QueensPermutations_Shards_t* QueensPermutations_ReadManifest(const QueensPermutation_BoardSize_t board_size);
+static uint16 QueensPermutations_GetManifestCrc(const QueensPermutations_ManifestHeader_t* const header, const QueensPermutations_ManifestEntry_t* const entries);
+static bool QueensPermutations_GetShardFilename(const QueensPermutation_BoardSize_t board_size, const QueensPermutations_QueenRowIndex_t* const prefix, const char* const extension, char* destination_filename); /* false if name doesn't fit in PATH_MAX */
+static bool QueensPermutations_SaveSymmetricToFile(const QueensPermutation_BoardSize_t board_size);
+static QueensPermutations_Result_t QueensPermutations_LoadSymmetricFromFile(const QueensPermutation_BoardSize_t board_size);
+static bool QueensPermutations_SourceGetRandomSymmetric(const QueensPermutations_Source_t* const source, QueensPermutations_QueenRowIndex_t* const board);
+static bool QueensPermutations_SourceReadNibbles(const QueensPermutations_Source_t* const source, const uint64 first_nibble, const uint32 nibbles_count, QueensPermutations_QueenRowIndex_t* const dest);
+static QueensPermutations_Source_t* QueensPermutations_SourceOpenCompletionCounts(const QueensPermutation_BoardSize_t board_size);
+static uint64* QueensPermutations_BuildCompletionCounts(const QueensPermutation_BoardSize_t board_size, uint64* const boards_count);
+static bool QueensPermutations_SourceUsesCompletionCounts(const QueensPermutation_BoardSize_t board_size);
+static bool QueensPermutations_SourceGetRandomFromCounts(const QueensPermutations_Source_t* const source, QueensPermutations_QueenRowIndex_t* const board);
+static bool QueensPermutations_SourceGetRandomTree(const QueensPermutations_Source_t* const source, QueensPermutations_QueenRowIndex_t* const board);
+static bool QueensPermutations_SourceBuildTreeIndex(QueensPermutations_Source_t* source);
+static bool QueensPermutations_SaveTreeToFile(const QueensPermutation_BoardSize_t board_size);
+static uint64 QueensPermutations_TreeBuildNode(QueensPermutations_TreeBuilder_t* builder, const uint8 column, const uint16 used_rows, const sint8 previous_row);
+static bool QueensPermutations_TreeBuilderReserve(QueensPermutations_TreeBuilder_t* builder, const uint64 bits_count);
+static void QueensPermutations_TreeBuilderRollback(QueensPermutations_TreeBuilder_t* builder, const uint64 bits_count);
+static void QueensPermutations_TreeWalkerInit(QueensPermutations_TreeWalker_t* walker, const uint8* const stream, const size_t stream_size, const QueensPermutation_BoardSize_t board_size, const QueensPermutations_QueenRowIndex_t* const prefix, const uint8 prefix_len, const uint64 bit_pos);
+static bool QueensPermutations_TreeWalkerStep(QueensPermutations_TreeWalker_t* walker, uint8* const column);
+static void QueensPermutations_TreeWalkerSkipSubtree(QueensPermutations_TreeWalker_t* walker);
+static bool QueensPermutations_TreeWalkerNext(QueensPermutations_TreeWalker_t* walker, QueensPermutations_QueenRowIndex_t* const board);
+static uint16 QueensPermutations_TreeReadChildren(QueensPermutations_TreeWalker_t* walker);
+static inline uint16 QueensPermutations_GetAdmissibleRows(const QueensPermutation_BoardSize_t board_size, const uint8 column, const uint16 used_rows, const sint8 previous_row);
+static void QueensPermutations_CursorRefillTree(QueensPermutations_Cursor_t* cursor);
+static bool QueensPermutations_SourceRead(const QueensPermutations_Source_t* const source, const uint64 payload_offset, const size_t length, uint8* const dest);
+static uint64 QueensPermutations_ExpandSymmetricRecords(const uint8* const packed_records, const uint64 records_count, const QueensPermutation_BoardSize_t board_size, QueensPermutations_QueenRowIndex_t* const boards);
+static void QueensPermutations_ApplySymmetry(const QueensPermutations_QueenRowIndex_t* const board, const QueensPermutation_BoardSize_t board_size, const uint8 symmetry, QueensPermutations_QueenRowIndex_t* const dest);
+static uint8 QueensPermutations_GetOrbitCode(const QueensPermutations_QueenRowIndex_t* const board, const QueensPermutation_BoardSize_t board_size);
+static bool QueensPermutations_FileWriterOpen(QueensPermutations_FileWriter_t* writer, const QueensPermutation_BoardSize_t board_size, const char* const filename);
+static void QueensPermutations_FileWriterPutNibble(QueensPermutations_FileWriter_t* writer, const uint8 nibble);
+static void QueensPermutations_FileWriterPutBytes(QueensPermutations_FileWriter_t* writer, const void* const data, const size_t length);
+static bool QueensPermutations_FileWriterClose(QueensPermutations_FileWriter_t* writer, const uint64 boards_count, const uint64 records_count);
+static void QueensPermutations_FileWriterAbort(QueensPermutations_FileWriter_t* writer);
+static FILE* QueensPermutations_OpenValidatedFile(const QueensPermutation_BoardSize_t board_size, QueensPermutations_FileHeader_t* header);
+static FILE* QueensPermutations_OpenValidatedFileAt(const char* const filename, const QueensPermutation_BoardSize_t board_size, QueensPermutations_FileHeader_t* header);
+static bool QueensPermutations_ReadBlockCrcs(FILE* file, const QueensPermutations_FileHeader_t* const header, QueensPermutations_BlockCrc_t* block_crc);
+static bool QueensPermutations_BlockCrcUpdate(QueensPermutations_BlockCrc_t* block_crc, const uint8* data, size_t length);
+static bool QueensPermutations_BlockCrcFinish(QueensPermutations_BlockCrc_t* block_crc);
+static bool QueensPermutations_VerifyPayload(FILE* file, const QueensPermutations_FileHeader_t* const header, const uint8* const payload);
+static bool QueensPermutations_VerifyFile(FILE* file, const QueensPermutations_FileHeader_t* const header);
+static uint16 QueensPermutations_GetHeaderCrc(const QueensPermutations_FileHeader_t* const header);
+static uint64 QueensPermutations_GetPayloadSize(const QueensPermutations_Encoding_t encoding, const QueensPermutation_BoardSize_t board_size, const uint64 records_count);
+static QueensPermutations_Encoding_t QueensPermutations_GetConfiguredEncoding(void);
+static QueensPermutations_Result_t QueensPermutations_LoadAllFromFile(const QueensPermutation_BoardSize_t board_size, const char* const filename);
+static QueensPermutations_Result_t QueensPermutations_MapAllFromFile(const QueensPermutation_BoardSize_t board_size, const char* const filename);
+static void QueensPermutations_Compress(QueensPermutations_Result_t* result);
+static bool QueensPermutations_BuildFileLocked(const QueensPermutation_BoardSize_t board_size);
+static int QueensPermutations_LockCache(const QueensPermutation_BoardSize_t board_size, bool* const waited);
+static void QueensPermutations_UnlockCache(const int lock_fd);
+static bool QueensPermutations_RemoveCorruptedFile(const QueensPermutation_BoardSize_t board_size);
+static bool QueensPermutations_GetFilename(QueensPermutation_BoardSize_t board_size, char* destination_filename); /* destination has to have PATH_MAX bytes, false if name doesn't fit in it */
+static bool QueensPermutations_CursorRead(QueensPermutations_Cursor_t* cursor, uint8* const buffer, const size_t length);
+
+/* per-size sources shared by QueensPermutations_GetRandom callers, opened on first use */
+static QueensPermutations_Source_t* QueensPermutations_shared_sources[QUEENS_MAX_BOARD_SIZE + 1u];
+static pthread_mutex_t QueensPermutations_shared_sources_mutex = PTHREAD_MUTEX_INITIALIZER;
+/* per-size shard manifests shared by QueensPermutations_GetShards callers, guarded by the same mutex */
+static QueensPermutations_Shards_t* QueensPermutations_shared_shards[QUEENS_MAX_BOARD_SIZE + 1u];
+
+/* QueensPermutations_GetCount results, 0 - not computed yet */
+static uint64 QueensPermutations_counts[QUEENS_MAX_BOARD_SIZE + 1u];
+static pthread_mutex_t QueensPermutations_counts_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 [[maybe_unused]] QueensPermutations_Result_t QueensPermutations_GetRandom(const QueensPermutation_BoardSize_t board_size)
+{
+    QueensPermutations_Result_t result = { 0 };
+    result.board_size = board_size;
+    result.success = false;
+
+    QueensPermutations_Source_t* source = QueensPermutations_GetSource(board_size);
+    if (source == NULL)
+    {
+        return result;
+    }
+
+    result.boards = malloc(board_size * sizeof(QueensPermutations_QueenRowIndex_t));
+    if (result.boards == NULL)
+    {
+        assert(false);
+        return result;
+    }
+
+    if (QueensPermutations_SourceGetRandom(source, result.boards) == false)
+    {
+        free(result.boards);
+        result.boards = NULL;
+        return result;
+    }
+
+    result.boards_count = 1u;
+    result.success = true;
+
+    return result; /* has to be freed by the caller (QueensPermutations_FreeResult) */
+}
+
+QueensPermutations_Source_t* QueensPermutations_SourceOpen(const QueensPermutation_BoardSize_t board_size)
+{
+    if ((board_size < QUEENS_MIN_BOARD_SIZE) ||
+        (board_size > QUEENS_MAX_BOARD_SIZE))
+    {
+        return NULL;
+    }
+
+    if (QueensPermutations_SourceUsesCompletionCounts(board_size) == true)
+    {
+        return QueensPermutations_SourceOpenCompletionCounts(board_size);
+    }
+
+    if (QueensPermutations_IsSharded() == true)
+    {
+        return QueensPermutations_SourceOpenShards(board_size);
+    }
+
+    /* check if file with board permutations has already been generated */
+    /* if not, create it first */
+
+    for (uint8 attempt = 0u; attempt < 2u; attempt++)
+    {
+        QueensPermutations_FileHeader_t header;
+        FILE *file = QueensPermutations_OpenValidatedFile(board_size, &header);
+        if (file == NULL)
+        {
+            /* file doesn't exist or is not valid */
+            bool write_success = QueensPermutations_BuildFile(board_size);
+            assert(write_success == true);
+
+            /* now that permutations are generated, open file again */
+            file = QueensPermutations_OpenValidatedFile(board_size, &header);
+            if (file == NULL)
+            {
+                assert(false);
+                return NULL;
+            }
+        }
+
+        QueensPermutations_Source_t* source = QueensPermutations_SourceOpenFile(file, &header, board_size);
+
+        /* payload didn't match block CRCs, regenerate the file once */
+        if ((source != NULL) ||
+            (attempt > 0u) ||
+            (QueensPermutations_RemoveCorruptedFile(board_size) == false))
+        {
+            return source;
+        }
+    }
+
+    return NULL;
+}
+
+/* takes over validated file, it is closed on failure as well */
+static QueensPermutations_Source_t* QueensPermutations_SourceOpenFile(FILE* file, const QueensPermutations_FileHeader_t* const file_header, const QueensPermutation_BoardSize_t board_size)
+{
+    const QueensPermutations_FileHeader_t header = *file_header;
+
+    if (header.records_count == 0u)
+    {
+        fclose(file);
+        return NULL;
+    }
+
+    QueensPermutations_Source_t* source = calloc(1u, sizeof(QueensPermutations_Source_t));
+    if (source == NULL)
+    {
+        assert(false);
+        fclose(file);
+        return NULL;
+    }
+
+    source->header = header;
+    source->board_size = board_size;
+
+    if (global_config.permutations_mmap == true)
+    {
+        const size_t mapping_size = sizeof(QueensPermutations_FileHeader_t) + (size_t)header.payload_size;
+        void* mapping = mmap(NULL, mapping_size, PROT_READ, MAP_SHARED, fileno(file), 0);
+
+        if (mapping != MAP_FAILED)
+        {
+            /* payload is checked once before it is used, same as for QueensPermutations_GetAll mapping */
+            const bool valid = QueensPermutations_VerifyPayload(file, &header, (const uint8*)mapping + sizeof(QueensPermutations_FileHeader_t));
+            fclose(file);
+            source->mapping = mapping;
+            source->mapping_size = mapping_size;
+            file = NULL;
+
+            if (valid == false)
+            {
+                QueensPermutations_SourceClose(source);
+                return NULL;
+            }
+        }
+    }
+
+    if (header.encoding == QUEENS_PERMUTATIONS_ENCODING_TREE)
+    {
+        /* boards can't be located in the stream directly, tree is kept in memory together with index of its upper levels */
+        if (source->mapping != NULL)
+        {
+            source->tree = &source->mapping[sizeof(QueensPermutations_FileHeader_t)];
+        }
+        else
+        {
+            uint8* tree = malloc((size_t)header.payload_size + 1u);
+            source->tree = tree;
+
+            bool read_success = (tree != NULL) &&
+                                (fread(tree, 1u, (size_t)header.payload_size, file) == header.payload_size) &&
+                                QueensPermutations_VerifyPayload(file, &header, tree);
+            fclose(file);
+
+            if (read_success == false)
+            {
+                QueensPermutations_SourceClose(source);
+                return NULL;
+            }
+        }
+
+        if (QueensPermutations_SourceBuildTreeIndex(source) == false)
+        {
+            QueensPermutations_SourceClose(source);
+            return NULL;
+        }
+
+        return source;
+    }
+
+    /* fall back to positioned reads, they don't share file position so the file can be read from many threads */
+    source->file = file;
+
+    return source;
+}
+
+uint64 QueensPermutations_SourceGetCount(const QueensPermutations_Source_t* const source)
+{
+    return source->header.boards_count;
+}
+
+bool QueensPermutations_SourceGetRandom(const QueensPermutations_Source_t* const source, QueensPermutations_QueenRowIndex_t* const board)
+{
+    if (source->completion_counts != NULL)
+    {
+        return QueensPermutations_SourceGetRandomFromCounts(source, board);
+    }
+
+    if (source->shards != NULL)
+    {
+        return QueensPermutations_SourceGetRandomSharded(source, board);
+    }
+
+    const QueensPermutation_BoardSize_t board_size = source->board_size;
+    const uint64 random_board_num = RNG_RandomRange_u64(0u, source->header.records_count - 1u);
+
+    switch ((QueensPermutations_Encoding_t)source->header.encoding)
+    {
+        case QUEENS_PERMUTATIONS_ENCODING_SYMMETRIC:
+            return QueensPermutations_SourceGetRandomSymmetric(source, board);
+        case QUEENS_PERMUTATIONS_ENCODING_TREE:
+            return QueensPermutations_SourceGetRandomTree(source, board);
+        case QUEENS_PERMUTATIONS_ENCODING_NIBBLE:
+            /* for odd board sizes, every other board starts from the middle of a byte */
+            return QueensPermutations_SourceReadNibbles(source, random_board_num * board_size, board_size, board);
+        case QUEENS_PERMUTATIONS_ENCODING_RAW:
+            return QueensPermutations_SourceRead(source, random_board_num * board_size, board_size, (uint8*)board);
+    }
+
+    return false;
+}
+
+void QueensPermutations_SourceClose(QueensPermutations_Source_t* source)
+{
+    if (source == NULL)
+    {
+        return;
+    }
+
+    if (source->mapping != NULL)
+    {
+        munmap((void*)source->mapping, source->mapping_size);
+    }
+    else
+    {
+        free((void*)source->tree);
+    }
+
+    free(source->tree_index);
+    free(source->completion_counts);
+
+    if (source->shards != NULL)
+    {
+        for (uint32 shard_idx = 0u; shard_idx < source->shards->header.shards_count; shard_idx++)
+        {
+            QueensPermutations_SourceClose(source->shard_sources[shard_idx]);
+        }
+
+        free(source->shard_sources);
+        QueensPermutations_ShardsClose(source->shards);
+    }
+
+    if (source->file != NULL)
+    {
+        fclose(source->file);
+    }
+
+    free(source);
+}
+
+QueensPermutations_Source_t* QueensPermutations_GetSource(const QueensPermutation_BoardSize_t board_size)
+{
+    if ((board_size < QUEENS_MIN_BOARD_SIZE) ||
+        (board_size > QUEENS_MAX_BOARD_SIZE))
+    {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&QueensPermutations_shared_sources_mutex);
+
+    QueensPermutations_Source_t* source = QueensPermutations_shared_sources[board_size];
+
+    /* sampling or file format options changed since the source was opened */
+    if ((source != NULL) &&
+        ((QueensPermutations_SourceUsesCompletionCounts(board_size) != (source->completion_counts != NULL)) ||
+         ((source->completion_counts == NULL) && (QueensPermutations_IsSharded() != (source->shards != NULL))) ||
+         ((source->completion_counts == NULL) && (source->header.encoding != (uint8)QueensPermutations_GetConfiguredEncoding()))))
+    {
+        QueensPermutations_SourceClose(source);
+        source = NULL;
+    }
+
+    if (source == NULL)
+    {
+        source = QueensPermutations_SourceOpen(board_size);
+        QueensPermutations_shared_sources[board_size] = source;
+    }
+
+    pthread_mutex_unlock(&QueensPermutations_shared_sources_mutex);
+
+    return source;
+}
+
+void QueensPermutations_CloseSharedSources(void)
+{
+    pthread_mutex_lock(&QueensPermutations_shared_sources_mutex);
+
+    for (uint8 board_size = 0u; board_size <= QUEENS_MAX_BOARD_SIZE; board_size++)
+    {
+        QueensPermutations_SourceClose(QueensPermutations_shared_sources[board_size]);
+        QueensPermutations_shared_sources[board_size] = NULL;
+        QueensPermutations_ShardsClose(QueensPermutations_shared_shards[board_size]);
+        QueensPermutations_shared_shards[board_size] = NULL;
+    }
+
+    pthread_mutex_unlock(&QueensPermutations_shared_sources_mutex);
+}
+
+QueensPermutations_Shards_t* QueensPermutations_ShardsOpen(const QueensPermutation_BoardSize_t board_size)
+{
+    if ((board_size < QUEENS_MIN_BOARD_SIZE) ||
+        (board_size > QUEENS_MAX_BOARD_SIZE))
+    {
+        return NULL;
+    }
+
+    const QueensPermutations_Encoding_t encoding = QueensPermutations_GetConfiguredEncoding();
+    if ((encoding != QUEENS_PERMUTATIONS_ENCODING_RAW) &&
+        (encoding != QUEENS_PERMUTATIONS_ENCODING_NIBBLE))
+    {
+        return NULL;
+    }
+
+    QueensPermutations_Shards_t* shards = QueensPermutations_ReadManifest(board_size);
+    if (shards == NULL)
+    {
+        /* manifest doesn't exist or is not valid, all shards are rebuilt */
+        if (QueensPermutations_BuildShards(board_size) == false)
+        {
+            return NULL;
+        }
+
+        shards = QueensPermutations_ReadManifest(board_size);
+    }
+
+    return shards;
+}
+
+uint32 QueensPermutations_ShardsGetCount(const QueensPermutations_Shards_t* const shards)
+{
+    return shards->header.shards_count;
+}
+
+const QueensPermutations_QueenRowIndex_t* QueensPermutations_ShardsGetPrefix(const QueensPermutations_Shards_t* const shards, const uint32 shard_idx)
+{
+    return shards->entries[shard_idx].prefix;
+}
+
+QueensPermutations_Result_t QueensPermutations_ShardsLoad(const QueensPermutations_Shards_t* const shards, const uint32 shard_idx)
+{
+    char filename[PATH_MAX];
+    if (QueensPermutations_GetShardFilename(shards->board_size, shards->entries[shard_idx].prefix, QUEENS_PERMUTATIONS_SHARD_EXTENSION, filename) == false)
+    {
+        QueensPermutations_Result_t failed_result = { 0 };
+        failed_result.board_size = shards->board_size;
+        failed_result.success = false;
+        return failed_result;
+    }
+
+    QueensPermutations_Result_t result = (global_config.permutations_mmap == true) ? QueensPermutations_MapAllFromFile(shards->board_size, filename) :
+                                                                                     QueensPermutations_LoadAllFromFile(shards->board_size, filename);
+
+    if ((result.success == true) &&
+        (result.boards_count != shards->entries[shard_idx].boards_count))
+    {
+        /* shard doesn't belong to the manifest */
+        (void)QueensPermutations_FreeResult(&result);
+        result.success = false;
+    }
+
+    return result; /* has to be freed by the caller (QueensPermutations_FreeResult) */
+}
+
+void QueensPermutations_ShardsClose(QueensPermutations_Shards_t* shards)
+{
+    if (shards == NULL)
+    {
+        return;
+    }
+
+    free(shards->entries);
+    free(shards->first_boards);
+    free(shards);
+}
+
+QueensPermutations_Shards_t* QueensPermutations_GetShards(const QueensPermutation_BoardSize_t board_size)
+{
+    if ((board_size < QUEENS_MIN_BOARD_SIZE) ||
+        (board_size > QUEENS_MAX_BOARD_SIZE))
+    {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&QueensPermutations_shared_sources_mutex);
+
+    QueensPermutations_Shards_t* shards = QueensPermutations_shared_shards[board_size];
+
+    /* shards of other encoding live in other files */
+    if ((shards != NULL) &&
+        (shards->header.encoding != (uint8)QueensPermutations_GetConfiguredEncoding()))
+    {
+        QueensPermutations_ShardsClose(shards);
+        shards = NULL;
+    }
+
+    if (shards == NULL)
+    {
+        shards = QueensPermutations_ShardsOpen(board_size);
+        QueensPermutations_shared_shards[board_size] = shards;
+    }
+
+    pthread_mutex_unlock(&QueensPermutations_shared_sources_mutex);
+
+    return shards;
+}
+
+uint64 QueensPermutations_GetCount(const QueensPermutation_BoardSize_t board_size)
+{
+    if ((board_size < QUEENS_MIN_BOARD_SIZE) ||
+        (board_size > QUEENS_MAX_BOARD_SIZE))
+    {
+        return 0u;
+    }
+
+    pthread_mutex_lock(&QueensPermutations_counts_mutex);
+
+    if (QueensPermutations_counts[board_size] == 0u)
+    {
+        /* counts table is only needed for the total */
+        free(QueensPermutations_BuildCompletionCounts(board_size, &QueensPermutations_counts[board_size]));
+    }
+
+    const uint64 boards_count = QueensPermutations_counts[board_size];
+
+    pthread_mutex_unlock(&QueensPermutations_counts_mutex);
+
+    return boards_count;
+}
+
+bool QueensPermutations_TableFits(const QueensPermutation_BoardSize_t board_size)
+{
+    /* estimated as unpacked boards, that is what symmetric and parallel-unpacked loads hold at peak */
+    const uint64 table_size = QueensPermutations_GetCount(board_size) * board_size;
+
+    return (global_config.permutations_table_max_size == 0u) ||
+           (table_size <= global_config.permutations_table_max_size);
+}
+
+[[maybe_unused]] QueensPermutations_Result_t QueensPermutations_GetAll(const QueensPermutation_BoardSize_t board_size)
 {
     QueensPermutations_Result_t result = { 0 };
 
     if ((board_size < QUEENS_MIN_BOARD_SIZE) ||
         (board_size > QUEENS_MAX_BOARD_SIZE))
     {
-        result.success = false;
+        result.success = false;
+        return result;
+    }
+
+
+    assert(sizeof(QueensPermutations_QueenRowIndex_t) == 1u);
+
+    if (QueensPermutations_TableFits(board_size) == false)
+    {
+        debug_print("Permutations table for board size %u exceeds configured maximum size, use table-free paths\n", board_size);
+        result.success = false;
+        return result;
+    }
+
+    /* check if file with board permutation has already been generated */
+    /* if yes, load from file. If no, generate new one and save to file */
+
+    QueensPermutations_FileHeader_t header;
+    FILE *file = QueensPermutations_OpenValidatedFile(board_size, &header);
+
+    if (file == NULL)
+    {
+        /* file doesn't exist or is not valid (truncated, other format version) */
+        const QueensPermutations_Encoding_t encoding = QueensPermutations_GetConfiguredEncoding();
+        if (((encoding == QUEENS_PERMUTATIONS_ENCODING_RAW) ||
+             (encoding == QUEENS_PERMUTATIONS_ENCODING_NIBBLE)) &&
+            (global_config.permutations_checkpoint == false))
+        {
+            /* other process may be generating the same table, its file is loaded once it is published */
+            bool waited = false;
+            const int lock_fd = QueensPermutations_LockCache(board_size, &waited);
+            file = (waited == true) ? QueensPermutations_OpenValidatedFile(board_size, &header) : NULL;
+
+            if (file == NULL)
+            {
+                result = QueensPermutations_Generate(board_size, global_config.permutations_generate_threads);
+                bool write_success = QueensPermutations_SaveToFile(&result);
+                assert(write_success == true);
+                QueensPermutations_UnlockCache(lock_fd);
+
+                if ((encoding == QUEENS_PERMUTATIONS_ENCODING_NIBBLE) &&
+                    (global_config.permutations_keep_packed == true))
+                {
+                    /* same layout as if it was loaded from the file just written */
+                    QueensPermutations_Compress(&result);
+                }
+
+                return result; /* has to be freed by the caller (QueensPermutations_FreeResult) */
+            }
+
+            QueensPermutations_UnlockCache(lock_fd);
+            fclose(file);
+        }
+        else if (QueensPermutations_BuildFile(board_size) == false)
+        {
+            return result;
+        }
+    }
+    else
+    {
+        fclose(file);
+    }
+
+    for (uint8 attempt = 0u; attempt < 2u; attempt++)
+    {
+        if (global_config.permutations_symmetry_reduced == true)
+        {
+            /* only canonical boards are stored, full set has to be expanded into heap */
+            result = QueensPermutations_LoadSymmetricFromFile(board_size);
+        }
+        else if (global_config.permutations_mmap == true)
+        {
+            result = QueensPermutations_MapAllFromFile(board_size, NULL);
+        }
+        else
+        {
+            result = QueensPermutations_LoadAllFromFile(board_size, NULL);
+        }
+
+        /* payload didn't match block CRCs, regenerate the file once */
+        if ((result.success == true) ||
+            (attempt > 0u) ||
+            (QueensPermutations_RemoveCorruptedFile(board_size) == false) ||
+            (QueensPermutations_BuildFile(board_size) == false))
+        {
+            break;
+        }
+    }
+
+    return result; /* has to be freed by the caller (QueensPermutations_FreeResult) */
+}
+
+[[maybe_unused]] bool QueensPermutations_BuildFile(const QueensPermutation_BoardSize_t board_size)
+{
+    /* only one process builds the file, others wait for it and use what it has published */
+    bool waited = false;
+    const int lock_fd = QueensPermutations_LockCache(board_size, &waited);
+
+    QueensPermutations_FileHeader_t header;
+    FILE* file = (waited == true) ? QueensPermutations_OpenValidatedFile(board_size, &header) : NULL;
+    bool success = true;
+
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+    else
+    {
+        /* first one to get the lock, or the process holding it has failed */
+        success = QueensPermutations_BuildFileLocked(board_size);
+    }
+
+    QueensPermutations_UnlockCache(lock_fd);
+
+    return success;
+}
+
+static bool QueensPermutations_BuildFileLocked(const QueensPermutation_BoardSize_t board_size)
+{
+    if (global_config.permutations_symmetry_reduced == true)
+    {
+        return QueensPermutations_SaveSymmetricToFile(board_size);
+    }
+
+    if (global_config.permutations_prefix_tree == true)
+    {
+        return QueensPermutations_SaveTreeToFile(board_size);
+    }
+
+    if (global_config.permutations_checkpoint == true)
+    {
+        /* long builds survive interruption, boards go to part files as they are enumerated */
+        return QueensPermutations_SaveCheckpointedToFile(board_size);
+    }
+
+    if (QueensPermutations_TableFits(board_size) == false)
+    {
+        /* table would not fit in memory, boards go to the file as they are enumerated */
+        uint64 boards_count;
+        return QueensPermutations_SaveEnumeratedToFile(board_size, NULL, 0u, NULL, &boards_count);
+    }
+
+    QueensPermutations_Result_t result = QueensPermutations_Generate(board_size, global_config.permutations_generate_threads);
+    if (result.success == false)
+    {
+        return false;
+    }
+
+    bool write_success = QueensPermutations_SaveToFile(&result);
+    (void)QueensPermutations_FreeResult(&result);
+
+    return write_success;
+}
+
+[[maybe_unused]] bool QueensPermutations_TraverseTree(const QueensPermutations_Result_t* const tree, const QueensPermutations_TreeVisitor_t visitor, void* const context)
+{
+    if ((tree->success == false) ||
+        (tree->prefix_tree == false))
+    {
+        return false;
+    }
+
+    QueensPermutations_TreeWalker_t walker;
+    QueensPermutations_TreeWalkerInit(&walker, (const uint8*)tree->boards, tree->tree_size, tree->board_size, NULL, 0u, 0u);
+
+    uint8 column;
+
+    while (QueensPermutations_TreeWalkerStep(&walker, &column) == true)
+    {
+        switch (visitor(context, column, walker.board[column]))
+        {
+            case QUEENS_PERMUTATIONS_VISIT_DESCEND:
+                break;
+            case QUEENS_PERMUTATIONS_VISIT_SKIP:
+                QueensPermutations_TreeWalkerSkipSubtree(&walker);
+                break;
+            case QUEENS_PERMUTATIONS_VISIT_STOP:
+                return true;
+        }
+    }
+
+    return true;
+}
+
+static bool QueensPermutations_SaveToFile(const QueensPermutations_Result_t* const result)
+{
+    if (result == NULL)
+    {
+        assert(false);
+        return false;
+    }
+
+    QueensPermutations_FileWriter_t writer;
+    if (QueensPermutations_FileWriterOpen(&writer, result->board_size, NULL) == false)
+    {
+        assert(false);
+        return false;
+    }
+
+    if (writer.header.encoding == QUEENS_PERMUTATIONS_ENCODING_NIBBLE)
+    {
+        for (size_t column_idx = 0u; column_idx < ((size_t)result->board_size*result->boards_count); column_idx++)
+        {
+            QueensPermutations_FileWriterPutNibble(&writer, (uint8)result->boards[column_idx]);
+        }
+    }
+    else
+    {
+        QueensPermutations_FileWriterPutBytes(&writer, result->boards, (size_t)result->board_size*result->boards_count);
+    }
+
+    return QueensPermutations_FileWriterClose(&writer, result->boards_count, result->boards_count);
+}
+
+/* boards starting with given prefix, filename NULL - cached file of given board size */
+static bool QueensPermutations_SaveEnumeratedToFile(const QueensPermutation_BoardSize_t board_size, const QueensPermutations_QueenRowIndex_t* const prefix, const uint8 prefix_len, const char* const filename, uint64* const boards_count)
+{
+    QueensPermutations_FileWriter_t writer;
+    if (QueensPermutations_FileWriterOpen(&writer, board_size, filename) == false)
+    {
+        assert(false);
+        return false;
+    }
+
+    QueensPermutations_Enumerator_t enumerator;
+    QueensPermutations_QueenRowIndex_t board[QUEENS_MAX_BOARD_SIZE];
+    QueensPermutations_EnumeratorInit(&enumerator, board_size, prefix, prefix_len);
+    *boards_count = 0u;
+
+    /* same order as QueensPermutations_Generate, only single-threaded */
+    while (QueensPermutations_EnumeratorNext(&enumerator, board) == true)
+    {
+        if (writer.header.encoding == QUEENS_PERMUTATIONS_ENCODING_NIBBLE)
+        {
+            for (uint8 column = 0u; column < board_size; column++)
+            {
+                QueensPermutations_FileWriterPutNibble(&writer, (uint8)board[column]);
+            }
+        }
+        else
+        {
+            QueensPermutations_FileWriterPutBytes(&writer, board, board_size);
+        }
+
+        (*boards_count)++;
+    }
+
+    return QueensPermutations_FileWriterClose(&writer, *boards_count, *boards_count);
+}
+
+static bool QueensPermutations_SaveSymmetricToFile(const QueensPermutation_BoardSize_t board_size)
+{
+    QueensPermutations_FileWriter_t writer;
+    if (QueensPermutations_FileWriterOpen(&writer, board_size, NULL) == false)
+    {
+        assert(false);
+        return false;
+    }
+
+    uint64 boards_count = 0u;
+    uint64 records_count = 0u;
+    QueensPermutations_Enumerator_t enumerator;
+    QueensPermutations_QueenRowIndex_t board[QUEENS_MAX_BOARD_SIZE];
+    QueensPermutations_EnumeratorInit(&enumerator, board_size, NULL, 0u);
+
+    /* keep only lexicographically smallest board of every orbit */
+    while (QueensPermutations_EnumeratorNext(&enumerator, board) == true)
+    {
+        const uint8 orbit_code = QueensPermutations_GetOrbitCode(board, board_size);
+        if (orbit_code == 0u)
+        {
+            continue;
+        }
+
+        for (uint8 column = 0u; column < board_size; column++)
+        {
+            QueensPermutations_FileWriterPutNibble(&writer, (uint8)board[column]);
+        }
+
+        QueensPermutations_FileWriterPutNibble(&writer, (uint8)(orbit_code >> NIBBLE_LEN));
+        QueensPermutations_FileWriterPutNibble(&writer, (uint8)(orbit_code & 0x0F));
+
+        boards_count += (uint64)__builtin_popcount(orbit_code);
+        records_count++;
+    }
+
+    return QueensPermutations_FileWriterClose(&writer, boards_count, records_count);
+}
+
+static QueensPermutations_Result_t QueensPermutations_LoadSymmetricFromFile(const QueensPermutation_BoardSize_t board_size)
+{
+    QueensPermutations_Result_t result = { 0 };
+    result.board_size = board_size;
+    result.success = false;
+
+    QueensPermutations_FileHeader_t header;
+    FILE *file = QueensPermutations_OpenValidatedFile(board_size, &header);
+    if (file == NULL)
+    {
+        return result;
+    }
+
+    const uint64 records_count = header.records_count;
+    const size_t records_size = (size_t)header.payload_size;
+    result.boards_count = header.boards_count;
+    uint8* packed_records = malloc(records_size);
+    result.boards = malloc((size_t)result.boards_count * board_size * sizeof(QueensPermutations_QueenRowIndex_t));
+
+    if ((packed_records == NULL) ||
+        (result.boards == NULL) ||
+        (fread(packed_records, 1u, records_size, file) != records_size) ||
+        (QueensPermutations_VerifyPayload(file, &header, packed_records) == false))
+    {
+        fclose(file);
+        free(packed_records);
+        free(result.boards);
+        result.boards = NULL;
+        return result;
+    }
+
+    fclose(file);
+
+    const uint64 expanded_count = QueensPermutations_ExpandSymmetricRecords(packed_records, records_count, board_size, result.boards);
+    free(packed_records);
+
+    if (expanded_count != result.boards_count)
+    {
+        /* orbit codes don't match the header */
+        free(result.boards);
+        result.boards = NULL;
+        return result;
+    }
+
+    result.success = true;
+
+    return result;
+}
+
+static bool QueensPermutations_IsSharded(void)
+{
+    /* symmetric and prefix tree stores can't be split by boards prefix */
+    const QueensPermutations_Encoding_t encoding = QueensPermutations_GetConfiguredEncoding();
+
+    return (global_config.permutations_sharded == true) &&
+           ((encoding == QUEENS_PERMUTATIONS_ENCODING_RAW) ||
+            (encoding == QUEENS_PERMUTATIONS_ENCODING_NIBBLE));
+}
+
+static QueensPermutations_Source_t* QueensPermutations_SourceOpenShards(const QueensPermutation_BoardSize_t board_size)
+{
+    QueensPermutations_Shards_t* shards = QueensPermutations_ShardsOpen(board_size);
+    if (shards == NULL)
+    {
+        return NULL;
+    }
+
+    QueensPermutations_Source_t* source = calloc(1u, sizeof(QueensPermutations_Source_t));
+    QueensPermutations_Source_t** shard_sources = calloc(shards->header.shards_count, sizeof(QueensPermutations_Source_t*));
+    if ((source == NULL) || (shard_sources == NULL))
+    {
+        assert(false);
+        free(source);
+        free(shard_sources);
+        QueensPermutations_ShardsClose(shards);
+        return NULL;
+    }
+
+    source->shards = shards;
+    source->shard_sources = shard_sources;
+    source->board_size = board_size;
+    source->header.encoding = shards->header.encoding;
+    source->header.boards_count = shards->header.boards_count;
+    source->header.records_count = shards->header.boards_count;
+
+    /* every shard is mapped (or opened for positioned reads), random board touches only the shard it falls into */
+    for (uint32 shard_idx = 0u; shard_idx < shards->header.shards_count; shard_idx++)
+    {
+        char filename[PATH_MAX];
+        QueensPermutations_FileHeader_t header;
+        FILE* file = (QueensPermutations_GetShardFilename(board_size, shards->entries[shard_idx].prefix, QUEENS_PERMUTATIONS_SHARD_EXTENSION, filename) == true) ?
+                     QueensPermutations_OpenValidatedFileAt(filename, board_size, &header) : NULL;
+
+        if ((file != NULL) &&
+            (header.boards_count != shards->entries[shard_idx].boards_count))
+        {
+            fclose(file);
+            file = NULL;
+        }
+
+        shard_sources[shard_idx] = (file != NULL) ? QueensPermutations_SourceOpenFile(file, &header, board_size) : NULL;
+        if (shard_sources[shard_idx] == NULL)
+        {
+            debug_print("Permutations shard %s is missing or doesn't match its manifest\n", filename);
+            QueensPermutations_SourceClose(source);
+            return NULL;
+        }
+    }
+
+    return source;
+}
+
+static bool QueensPermutations_SourceGetRandomSharded(const QueensPermutations_Source_t* const source, QueensPermutations_QueenRowIndex_t* const board)
+{
+    const QueensPermutations_Shards_t* const shards = source->shards;
+    const uint64 random_board_num = RNG_RandomRange_u64(0u, shards->header.boards_count - 1u);
+
+    /* shard is picked with probability proportional to its boards count - last shard starting at or before the drawn board */
+    uint32 low = 0u;
+    uint32 high = shards->header.shards_count - 1u;
+    while (low < high)
+    {
+        const uint32 middle = low + ((high - low + 1u) / 2u);
+        if (shards->first_boards[middle] <= random_board_num)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle - 1u;
+        }
+    }
+
+    return QueensPermutations_SourceGetRandom(source->shard_sources[low], board);
+}
+
+/*
+    every admissible prefix of QUEENS_PERMUTATIONS_SHARD_PREFIX_LEN rows gets its own permutations file,
+    manifest listing non-empty shards with their boards counts is published last
+*/
+static bool QueensPermutations_BuildShards(const QueensPermutation_BoardSize_t board_size)
+{
+    /* shares the lock with the unsharded file, only one process builds the shards */
+    bool waited = false;
+    const int lock_fd = QueensPermutations_LockCache(board_size, &waited);
+
+    if (waited == true)
+    {
+        QueensPermutations_Shards_t* shards = QueensPermutations_ReadManifest(board_size);
+        if (shards != NULL)
+        {
+            QueensPermutations_ShardsClose(shards);
+            QueensPermutations_UnlockCache(lock_fd);
+            return true;
+        }
+    }
+
+    QueensPermutations_ShardsJob_t job = { 0 };
+    job.board_size = board_size;
+    job.extension = QUEENS_PERMUTATIONS_SHARD_EXTENSION;
+
+    bool success = QueensPermutations_RunPrefixJob(&job);
+
+    if (success == true)
+    {
+        /* empty shards are not listed, their files are removed */
+        uint32 shards_count = 0u;
+        for (uint32 entry_idx = 0u; entry_idx < job.entries_count; entry_idx++)
+        {
+            if (job.entries[entry_idx].boards_count == 0u)
+            {
+                char filename[PATH_MAX];
+                if (QueensPermutations_GetShardFilename(board_size, job.entries[entry_idx].prefix, QUEENS_PERMUTATIONS_SHARD_EXTENSION, filename) == true)
+                {
+                    (void)remove(filename);
+                }
+            }
+            else
+            {
+                job.entries[shards_count++] = job.entries[entry_idx];
+            }
+        }
+
+        success = QueensPermutations_SaveManifest(board_size, job.entries, shards_count);
+    }
+
+    free(job.entries);
+    QueensPermutations_UnlockCache(lock_fd);
+
+    return success;
+}
+
+/*
+    cached file is assembled from part files of the same prefixes as shards, every part is published as soon as it is enumerated.
+    Parts left by an interrupted build are reused, so the build resumes from the last completed prefix.
+    Parts are concatenated in prefix order, which is enumeration order - the file is the same as if it was built in one go
+*/
+static bool QueensPermutations_SaveCheckpointedToFile(const QueensPermutation_BoardSize_t board_size)
+{
+    QueensPermutations_ShardsJob_t job = { 0 };
+    job.board_size = board_size;
+    job.extension = QUEENS_PERMUTATIONS_PART_EXTENSION;
+
+    if (QueensPermutations_RunPrefixJob(&job) == false)
+    {
+        free(job.entries);
+        return false;
+    }
+
+    QueensPermutations_FileWriter_t writer;
+    if (QueensPermutations_FileWriterOpen(&writer, board_size, NULL) == false)
+    {
+        assert(false);
+        free(job.entries);
+        return false;
+    }
+
+    QueensPermutations_QueenRowIndex_t board_buffer[QUEENS_MAX_BOARD_SIZE];
+    uint64 boards_count = 0u;
+    bool success = true;
+
+    for (uint32 entry_idx = 0u; (entry_idx < job.entries_count) && (success == true); entry_idx++)
+    {
+        char filename[PATH_MAX];
+        if (QueensPermutations_GetShardFilename(board_size, job.entries[entry_idx].prefix, QUEENS_PERMUTATIONS_PART_EXTENSION, filename) == false)
+        {
+            success = false;
+            break;
+        }
+
+        QueensPermutations_Result_t part = QueensPermutations_LoadAllFromFile(board_size, filename);
+        if (part.success == false)
+        {
+            /* payload didn't match block CRCs, the part is enumerated again next time */
+            (void)remove(filename);
+            success = false;
+            break;
+        }
+
+        for (uint64 board_idx = 0u; board_idx < part.boards_count; board_idx++)
+        {
+            const QueensPermutations_QueenRowIndex_t* board = QueensPermutations_GetBoard(&part, board_idx, board_buffer);
+
+            if (writer.header.encoding == QUEENS_PERMUTATIONS_ENCODING_NIBBLE)
+            {
+                for (uint8 column = 0u; column < board_size; column++)
+                {
+                    QueensPermutations_FileWriterPutNibble(&writer, (uint8)board[column]);
+                }
+            }
+            else
+            {
+                QueensPermutations_FileWriterPutBytes(&writer, board, board_size);
+            }
+        }
+
+        boards_count += part.boards_count;
+        (void)QueensPermutations_FreeResult(&part);
+    }
+
+    if (success == false)
+    {
+        QueensPermutations_FileWriterAbort(&writer);
+        free(job.entries);
+        return false;
+    }
+
+    success = QueensPermutations_FileWriterClose(&writer, boards_count, boards_count);
+
+    if (success == true)
+    {
+        for (uint32 entry_idx = 0u; entry_idx < job.entries_count; entry_idx++)
+        {
+            char filename[PATH_MAX];
+            if (QueensPermutations_GetShardFilename(board_size, job.entries[entry_idx].prefix, QUEENS_PERMUTATIONS_PART_EXTENSION, filename) == true)
+            {
+                (void)remove(filename);
+            }
+        }
+
+        /* temporary files that were being written when earlier build was interrupted, cache lock is held so nobody else writes them now */
+        char filename[PATH_MAX];
+        if (QueensPermutations_GetFilename(board_size, filename) == true)
+        {
+            char pattern[PATH_MAX];
+
+            /* parts (name without ".bin") */
+            if (snprintf(pattern, sizeof(pattern), "%.*s_*.part.*", (int)(strlen(filename) - 4u), filename) < (int)sizeof(pattern))
+            {
+                QueensPermutations_RemoveMatchingFiles(pattern);
+            }
+
+            /* file itself, see QueensPermutations_FileWriterOpen */
+            if (snprintf(pattern, sizeof(pattern), "%s.??????", filename) < (int)sizeof(pattern))
+            {
+                QueensPermutations_RemoveMatchingFiles(pattern);
+            }
+        }
+    }
+
+    free(job.entries);
+
+    return success;
+}
+
+static void QueensPermutations_RemoveMatchingFiles(const char* const pattern)
+{
+    glob_t matching_files;
+    if (glob(pattern, 0, NULL, &matching_files) == 0)
+    {
+        for (size_t file_idx = 0u; file_idx < matching_files.gl_pathc; file_idx++)
+        {
+            (void)remove(matching_files.gl_pathv[file_idx]);
+        }
+    }
+
+    globfree(&matching_files);
+}
+
+/* builds file of every admissible prefix, entries are allocated here and have to be freed by the caller */
+static bool QueensPermutations_RunPrefixJob(QueensPermutations_ShardsJob_t* job)
+{
+    const QueensPermutation_BoardSize_t board_size = job->board_size;
+
+    static_assert(QUEENS_PERMUTATIONS_SHARD_PREFIX_LEN == 2u);
+
+    job->entries = calloc((size_t)board_size * board_size, sizeof(QueensPermutations_ManifestEntry_t));
+    if (job->entries == NULL)
+    {
+        assert(false);
+        return false;
+    }
+
+    for (uint8 row_0 = 0u; row_0 < board_size; row_0++)
+    {
+        for (uint8 row_1 = 0u; row_1 < board_size; row_1++)
+        {
+            /* queens in neighbouring columns can't share row nor touch diagonally */
+            if (abs((int)row_0 - (int)row_1) > 1)
+            {
+                job->entries[job->entries_count].prefix[0] = (QueensPermutations_QueenRowIndex_t)row_0;
+                job->entries[job->entries_count].prefix[1] = (QueensPermutations_QueenRowIndex_t)row_1;
+                job->entries_count++;
+            }
+        }
+    }
+
+    atomic_init(&job->next_entry, 0u);
+    atomic_init(&job->failed, false);
+
+    /* every thread claims prefixes from the shared job */
+    ThreadPool_Run(QueensPermutations_BuildShardsWorker, job, 0u, ThreadPool_GetThreadsCount(global_config.permutations_generate_threads, job->entries_count));
+
+    return (atomic_load(&job->failed) == false);
+}
+
+static void* QueensPermutations_BuildShardsWorker(void* arg)
+{
+    QueensPermutations_ShardsJob_t* job = (QueensPermutations_ShardsJob_t*)arg;
+
+    for (;;)
+    {
+        const uint32 entry_idx = atomic_fetch_add(&job->next_entry, 1u);
+        if ((entry_idx >= job->entries_count) ||
+            (atomic_load(&job->failed) == true))
+        {
+            break;
+        }
+
+        QueensPermutations_ManifestEntry_t* entry = &job->entries[entry_idx];
+
+        char filename[PATH_MAX];
+        if (QueensPermutations_GetShardFilename(job->board_size, entry->prefix, job->extension, filename) == false)
+        {
+            atomic_store(&job->failed, true);
+            break;
+        }
+
+        /* file left by an earlier interrupted build, it is published only once complete */
+        QueensPermutations_FileHeader_t header;
+        FILE* file = QueensPermutations_OpenValidatedFileAt(filename, job->board_size, &header);
+        if (file != NULL)
+        {
+            fclose(file);
+            entry->boards_count = header.boards_count;
+            continue;
+        }
+
+        if (QueensPermutations_SaveEnumeratedToFile(job->board_size, entry->prefix, QUEENS_PERMUTATIONS_SHARD_PREFIX_LEN, filename, &entry->boards_count) == false)
+        {
+            atomic_store(&job->failed, true);
+        }
+    }
+
+    return NULL;
+}
+
+static bool QueensPermutations_SaveManifest(const QueensPermutation_BoardSize_t board_size, const QueensPermutations_ManifestEntry_t* const entries, const uint32 entries_count)
+{
+    QueensPermutations_ManifestHeader_t header = { 0 };
+    header.magic = QUEENS_PERMUTATIONS_MANIFEST_MAGIC;
+    header.version = QUEENS_PERMUTATIONS_MANIFEST_VERSION;
+    header.board_size = board_size;
+    header.encoding = (uint8)QueensPermutations_GetConfiguredEncoding();
+    header.shards_count = entries_count;
+
+    for (uint32 entry_idx = 0u; entry_idx < entries_count; entry_idx++)
+    {
+        header.boards_count += entries[entry_idx].boards_count;
+    }
+
+    header.crc = QueensPermutations_GetManifestCrc(&header, entries);
+
+    /* same as for permutations files - manifest appears under its name only once complete */
+    char filename[PATH_MAX];
+    char temp_filename[PATH_MAX];
+    if ((QueensPermutations_GetShardFilename(board_size, NULL, QUEENS_PERMUTATIONS_SHARD_EXTENSION, filename) == false) ||
+        (snprintf(temp_filename, sizeof(temp_filename), "%s.XXXXXX", filename) >= (int)sizeof(temp_filename)))
+    {
+        return false;
+    }
+
+    const int fd = mkstemp(temp_filename);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    (void)fchmod(fd, 0644);
+
+    FILE* file = fdopen(fd, "wb");
+    if (file == NULL)
+    {
+        close(fd);
+        (void)remove(temp_filename);
+        return false;
+    }
+
+    bool success = (fwrite(&header, sizeof(header), 1u, file) == 1u) &&
+                   (fwrite(entries, sizeof(QueensPermutations_ManifestEntry_t), entries_count, file) == entries_count);
+    success = (fclose(file) == 0) && success;
+    success = success && (rename(temp_filename, filename) == 0);
+
+    if (success == false)
+    {
+        (void)remove(temp_filename);
+    }
+
+    return success;
+}
+
+static QueensPermutations_Shards_t* QueensPermutations_ReadManifest(const QueensPermutation_BoardSize_t board_size)
+{
+    char filename[PATH_MAX];
+    if (QueensPermutations_GetShardFilename(board_size, NULL, QUEENS_PERMUTATIONS_SHARD_EXTENSION, filename) == false)
+    {
+        return NULL;
+    }
+
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL)
+    {
+        return NULL;
+    }
+
+    QueensPermutations_Shards_t* shards = calloc(1u, sizeof(QueensPermutations_Shards_t));
+    if (shards == NULL)
+    {
+        assert(false);
+        fclose(file);
+        return NULL;
+    }
+
+    shards->board_size = board_size;
+
+    bool valid = (fread(&shards->header, sizeof(shards->header), 1u, file) == 1u) &&
+                 (shards->header.magic == QUEENS_PERMUTATIONS_MANIFEST_MAGIC) &&
+                 (shards->header.version == QUEENS_PERMUTATIONS_MANIFEST_VERSION) &&
+                 (shards->header.board_size == board_size) &&
+                 (shards->header.encoding == (uint8)QueensPermutations_GetConfiguredEncoding()) &&
+                 (shards->header.shards_count > 0u) &&
+                 (shards->header.shards_count <= (uint32)board_size * board_size);
+
+    if (valid == true)
+    {
+        shards->entries = malloc(shards->header.shards_count * sizeof(QueensPermutations_ManifestEntry_t));
+        shards->first_boards = malloc(shards->header.shards_count * sizeof(uint64));
+        valid = (shards->entries != NULL) &&
+                (shards->first_boards != NULL) &&
+                (fread(shards->entries, sizeof(QueensPermutations_ManifestEntry_t), shards->header.shards_count, file) == shards->header.shards_count) &&
+                (QueensPermutations_GetManifestCrc(&shards->header, shards->entries) == shards->header.crc);
+    }
+
+    fclose(file);
+
+    if (valid == true)
+    {
+        uint64 boards_count = 0u;
+        for (uint32 shard_idx = 0u; shard_idx < shards->header.shards_count; shard_idx++)
+        {
+            shards->first_boards[shard_idx] = boards_count;
+            boards_count += shards->entries[shard_idx].boards_count;
+        }
+
+        /* shards written by an interrupted or different build don't add up */
+        valid = (boards_count == shards->header.boards_count) &&
+                (boards_count == QueensPermutations_GetCount(board_size));
+    }
+
+    if (valid == false)
+    {
+        debug_print("Permutations manifest %s is corrupted or stale, shards will be regenerated\n", filename);
+        QueensPermutations_ShardsClose(shards);
+        return NULL;
+    }
+
+    return shards;
+}
+
+static uint16 QueensPermutations_GetManifestCrc(const QueensPermutations_ManifestHeader_t* const header, const QueensPermutations_ManifestEntry_t* const entries)
+{
+    QueensPermutations_ManifestHeader_t header_copy = *header;
+    header_copy.crc = 0u;
+
+    const uint16 crc = CRC_CalculateCRC16((const uint8*)&header_copy, sizeof(header_copy));
+    return CRC_UpdateCRC16(crc, (const uint8*)entries, header->shards_count * sizeof(QueensPermutations_ManifestEntry_t));
+}
+
+/*
+    completion counts: number of ways to finish a board given rows used so far and row of the last placed queen
+    (column is implied by number of used rows). Drawing uniform board number and unranking it against the counts
+    gives uniform permutation without any table, 2^n * n counts are needed (4 MB for board size 15)
+*/
+static QueensPermutations_Source_t* QueensPermutations_SourceOpenCompletionCounts(const QueensPermutation_BoardSize_t board_size)
+{
+    QueensPermutations_Source_t* source = calloc(1u, sizeof(QueensPermutations_Source_t));
+    if (source == NULL)
+    {
+        assert(false);
+        return NULL;
+    }
+
+    source->board_size = board_size;
+    source->completion_counts = QueensPermutations_BuildCompletionCounts(board_size, &source->header.boards_count);
+    if (source->completion_counts == NULL)
+    {
+        free(source);
+        return NULL;
+    }
+
+    source->header.records_count = source->header.boards_count;
+    source->header.board_size = board_size;
+
+    return source;
+}
+
+/* (used_rows, previous_row) indexed counts, boards_count receives the total */
+static uint64* QueensPermutations_BuildCompletionCounts(const QueensPermutation_BoardSize_t board_size, uint64* const boards_count)
+{
+    const uint32 masks_count = 1u << board_size;
+    const uint16 all_rows = (uint16)(masks_count - 1u);
+
+    uint64* const counts = calloc((size_t)masks_count * board_size, sizeof(uint64));
+    if (counts == NULL)
+    {
+        assert(false);
+        return NULL;
+    }
+
+    /* every state depends only on states with more rows used, which have higher masks */
+    for (uint32 used_rows = all_rows; used_rows > 0u; used_rows--)
+    {
+        for (uint16 rows = (uint16)used_rows; rows != 0u; rows &= (uint16)(rows - 1u))
+        {
+            const sint8 previous_row = (sint8)__builtin_ctz(rows);
+            uint64 completions_count = (used_rows == all_rows) ? 1u : 0u;
+
+            for (uint16 next_rows = QueensPermutations_GetAdmissibleRows(board_size, 1u, (uint16)used_rows, previous_row); next_rows != 0u; next_rows &= (uint16)(next_rows - 1u))
+            {
+                const uint8 row = (uint8)__builtin_ctz(next_rows);
+                completions_count += counts[(size_t)(used_rows | (1u << row)) * board_size + row];
+            }
+
+            counts[(size_t)used_rows * board_size + (uint8)previous_row] = completions_count;
+        }
+    }
+
+    /* empty board, any row can be used in the first column */
+    *boards_count = 0u;
+    for (uint8 row = 0u; row < board_size; row++)
+    {
+        *boards_count += counts[(size_t)(1u << row) * board_size + row];
+    }
+
+    return counts;
+}
+
+/* completion counts are used if configured, or if the cached file would have to hold a table that doesn't fit */
+static bool QueensPermutations_SourceUsesCompletionCounts(const QueensPermutation_BoardSize_t board_size)
+{
+    return (global_config.permutations_sample_from_counts == true) ||
+           (QueensPermutations_TableFits(board_size) == false);
+}
+
+static bool QueensPermutations_SourceGetRandomFromCounts(const QueensPermutations_Source_t* const source, QueensPermutations_QueenRowIndex_t* const board)
+{
+    const QueensPermutation_BoardSize_t board_size = source->board_size;
+    const uint64* const counts = source->completion_counts;
+
+    /* board_num-th permutation in lexicographic order */
+    uint64 board_num = RNG_RandomRange_u64(0u, source->header.boards_count - 1u);
+    uint16 used_rows = 0u;
+    sint8 previous_row = QUEEN_ROW_NOT_EXISTS;
+
+    for (uint8 column = 0u; column < board_size; column++)
+    {
+        sint8 chosen_row = QUEEN_ROW_NOT_EXISTS;
+
+        for (uint16 rows = QueensPermutations_GetAdmissibleRows(board_size, column, used_rows, previous_row); rows != 0u; rows &= (uint16)(rows - 1u))
+        {
+            const uint8 row = (uint8)__builtin_ctz(rows);
+            const uint64 completions_count = counts[(size_t)(used_rows | (1u << row)) * board_size + row];
+
+            if (board_num < completions_count)
+            {
+                chosen_row = (sint8)row;
+                break;
+            }
+
+            board_num -= completions_count;
+        }
+
+        if (chosen_row == QUEEN_ROW_NOT_EXISTS)
+        {
+            assert(false);
+            return false;
+        }
+
+        board[column] = chosen_row;
+        used_rows |= (uint16)(1u << chosen_row);
+        previous_row = chosen_row;
+    }
+
+    return true;
+}
+
+static bool QueensPermutations_SourceGetRandomSymmetric(const QueensPermutations_Source_t* const source, QueensPermutations_QueenRowIndex_t* const board)
+{
+    const uint64 records_count = source->header.records_count;
+    const uint8 board_size = source->board_size;
+    const uint32 record_nibbles = board_size + QUEENS_PERMUTATIONS_ORBIT_CODE_NIBBLES;
+    QueensPermutations_QueenRowIndex_t record[QUEENS_MAX_BOARD_SIZE + QUEENS_PERMUTATIONS_ORBIT_CODE_NIBBLES];
+
+    /*
+        every board of the full set is produced by exactly one (record, symmetry) pair with symmetry bit set in record's orbit code.
+        Drawing both uniformly and rejecting pairs with bit cleared gives uniform distribution over the full set
+    */
+    for (;;)
+    {
+        const uint64 record_idx = RNG_RandomRange_u64(0u, records_count - 1u);
+        const uint8 symmetry = (uint8)RNG_RandomRange_u32(0u, QUEENS_PERMUTATIONS_SYMMETRIES_COUNT - 1u);
+
+        if (QueensPermutations_SourceReadNibbles(source, record_idx * record_nibbles, record_nibbles, record) == false)
+        {
+            return false;
+        }
+
+        const uint8 orbit_code = (uint8)(((uint8)record[board_size] << NIBBLE_LEN) | (uint8)record[board_size + 1u]);
+        if ((orbit_code & (1u << symmetry)) != 0u)
+        {
+            QueensPermutations_ApplySymmetry(record, board_size, symmetry, board);
+            return true;
+        }
+    }
+}
+
+static bool QueensPermutations_SourceGetRandomTree(const QueensPermutations_Source_t* const source, QueensPermutations_QueenRowIndex_t* const board)
+{
+    const uint64 board_num = RNG_RandomRange_u64(0u, source->header.boards_count - 1u);
+
+    /* last indexed node starting at or before requested board */
+    uint32 low = 0u;
+    uint32 high = source->tree_index_count - 1u;
+
+    while (low < high)
+    {
+        const uint32 middle = (low + high + 1u) / 2u;
+        if (source->tree_index[middle].first_board <= board_num)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle - 1u;
+        }
+    }
+
+    const QueensPermutations_TreeIndexEntry_t* entry = &source->tree_index[low];
+    QueensPermutations_TreeWalker_t walker;
+    QueensPermutations_TreeWalkerInit(&walker, source->tree, (size_t)source->header.payload_size, source->board_size, entry->prefix, QUEENS_PERMUTATIONS_TREE_INDEX_DEPTH, entry->bit_pos);
+
+    for (uint64 board_idx = entry->first_board; board_idx <= board_num; board_idx++)
+    {
+        if (QueensPermutations_TreeWalkerNext(&walker, board) == false)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool QueensPermutations_SourceBuildTreeIndex(QueensPermutations_Source_t* source)
+{
+    QueensPermutations_TreeWalker_t walker;
+    QueensPermutations_TreeWalkerInit(&walker, source->tree, (size_t)source->header.payload_size, source->board_size, NULL, 0u, 0u);
+
+    uint32 index_capacity = 0u;
+    uint64 boards_count = 0u;
+    uint64 bit_pos = walker.bit_pos;
+    uint8 column;
+
+    while (QueensPermutations_TreeWalkerStep(&walker, &column) == true)
+    {
+        if ((column + 1u) == QUEENS_PERMUTATIONS_TREE_INDEX_DEPTH)
+        {
+            if (source->tree_index_count == index_capacity)
+            {
+                index_capacity = (index_capacity == 0u) ? 1024u : (index_capacity * 2u);
+                QueensPermutations_TreeIndexEntry_t* tree_index = realloc(source->tree_index, index_capacity * sizeof(QueensPermutations_TreeIndexEntry_t));
+                if (tree_index == NULL)
+                {
+                    assert(false);
+                    return false;
+                }
+
+                source->tree_index = tree_index;
+            }
+
+            /* step has just read the node, bit_pos is where it starts */
+            QueensPermutations_TreeIndexEntry_t* entry = &source->tree_index[source->tree_index_count++];
+            entry->first_board = boards_count;
+            entry->bit_pos = bit_pos;
+            memcpy(entry->prefix, walker.board, sizeof(entry->prefix));
+        }
+
+        if ((column + 1u) == source->board_size)
+        {
+            boards_count++;
+        }
+
+        bit_pos = walker.bit_pos;
+    }
+
+    /* stream has to describe exactly the boards announced by the header */
+    return (source->tree_index_count > 0u) && (boards_count == source->header.boards_count);
+}
+
+/* reads nibble-packed payload starting at any nibble, one nibble per destination element */
+static bool QueensPermutations_SourceReadNibbles(const QueensPermutations_Source_t* const source, const uint64 first_nibble, const uint32 nibbles_count, QueensPermutations_QueenRowIndex_t* const dest)
+{
+    uint8 packed[QUEENS_MAX_BOARD_SIZE];
+    const uint32 start_nibble = (uint32)(first_nibble % 2u);
+    const size_t bytes_count = (start_nibble + nibbles_count + 1u) / 2u;
+
+    assert(bytes_count <= sizeof(packed));
+
+    if (QueensPermutations_SourceRead(source, first_nibble / 2u, bytes_count, packed) == false)
+    {
+        return false;
+    }
+
+    Nibble_Unpack((uint8*)dest, packed, start_nibble, nibbles_count);
+
+    return true;
+}
+
+static bool QueensPermutations_SourceRead(const QueensPermutations_Source_t* const source, const uint64 payload_offset, const size_t length, uint8* const dest)
+{
+    const uint64 file_offset = sizeof(QueensPermutations_FileHeader_t) + payload_offset;
+
+    if (source->mapping != NULL)
+    {
+        memcpy(dest, &source->mapping[file_offset], length);
+        return true;
+    }
+
+    return (pread(fileno(source->file), dest, length, (off_t)file_offset) == (ssize_t)length);
+}
+
+static uint64 QueensPermutations_ExpandSymmetricRecords(const uint8* const packed_records, const uint64 records_count, const QueensPermutation_BoardSize_t board_size, QueensPermutations_QueenRowIndex_t* const boards)
+{
+    /* boards has to have space for 8 boards per record, returns number of boards written */
+    const uint32 record_nibbles = board_size + QUEENS_PERMUTATIONS_ORBIT_CODE_NIBBLES;
+    QueensPermutations_QueenRowIndex_t record[QUEENS_MAX_BOARD_SIZE + QUEENS_PERMUTATIONS_ORBIT_CODE_NIBBLES];
+    uint64 boards_count = 0u;
+
+    for (uint64 record_idx = 0u; record_idx < records_count; record_idx++)
+    {
+        Nibble_Unpack((uint8*)record, packed_records, (size_t)record_idx * record_nibbles, record_nibbles);
+
+        const uint8 orbit_code = (uint8)(((uint8)record[board_size] << NIBBLE_LEN) | (uint8)record[board_size + 1u]);
+
+        for (uint8 symmetry = 0u; symmetry < QUEENS_PERMUTATIONS_SYMMETRIES_COUNT; symmetry++)
+        {
+            if ((orbit_code & (1u << symmetry)) != 0u)
+            {
+                QueensPermutations_ApplySymmetry(record, board_size, symmetry, &boards[(size_t)boards_count * board_size]);
+                boards_count++;
+            }
+        }
+    }
+
+    return boards_count;
+}
+
+static void QueensPermutations_ApplySymmetry(const QueensPermutations_QueenRowIndex_t* const board, const QueensPermutation_BoardSize_t board_size, const uint8 symmetry, QueensPermutations_QueenRowIndex_t* const dest)
+{
+    QueensPermutations_QueenRowIndex_t transformed[QUEENS_MAX_BOARD_SIZE];
+    const sint8 last = (sint8)(board_size - 1u);
+
+    for (uint8 column = 0u; column < board_size; column++)
+    {
+        /* reverse columns */
+        QueensPermutations_QueenRowIndex_t row = ((symmetry & 0b001) != 0u) ? board[last - column] : board[column];
+
+        /* flip rows */
+        if ((symmetry & 0b010) != 0u)
+        {
+            row = (QueensPermutations_QueenRowIndex_t)(last - row);
+        }
+
+        transformed[column] = row;
+    }
+
+    for (uint8 column = 0u; column < board_size; column++)
+    {
+        /* transpose - queen in (row, column) moves to (column, row) */
+        if ((symmetry & 0b100) != 0u)
+        {
+            dest[transformed[column]] = (QueensPermutations_QueenRowIndex_t)column;
+        }
+        else
+        {
+            dest[column] = transformed[column];
+        }
+    }
+}
+
+/* 0 if board is not the canonical (lexicographically smallest) member of its orbit, orbit code otherwise */
+static uint8 QueensPermutations_GetOrbitCode(const QueensPermutations_QueenRowIndex_t* const board, const QueensPermutation_BoardSize_t board_size)
+{
+    QueensPermutations_QueenRowIndex_t images[QUEENS_PERMUTATIONS_SYMMETRIES_COUNT][QUEENS_MAX_BOARD_SIZE];
+    uint8 orbit_code = 0u;
+
+    for (uint8 symmetry = 0u; symmetry < QUEENS_PERMUTATIONS_SYMMETRIES_COUNT; symmetry++)
+    {
+        QueensPermutations_ApplySymmetry(board, board_size, symmetry, images[symmetry]);
+
+        if (memcmp(images[symmetry], board, board_size) < 0)
+        {
+            return 0u;
+        }
+
+        /* symmetries that map the board onto an already produced one are skipped during expansion */
+        bool new_board = true;
+        for (uint8 previous_symmetry = 0u; previous_symmetry < symmetry; previous_symmetry++)
+        {
+            if (memcmp(images[symmetry], images[previous_symmetry], board_size) == 0)
+            {
+                new_board = false;
+                break;
+            }
+        }
+
+        if (new_board == true)
+        {
+            orbit_code |= (uint8)(1u << symmetry);
+        }
+    }
+
+    return orbit_code;
+}
+
+static bool QueensPermutations_SaveTreeToFile(const QueensPermutation_BoardSize_t board_size)
+{
+    /* tree is built in memory first, node bits are only known once its subtrees are complete */
+    QueensPermutations_TreeBuilder_t builder = { 0 };
+    builder.board_size = board_size;
+
+    const uint64 boards_count = QueensPermutations_TreeBuildNode(&builder, 0u, 0u, QUEEN_ROW_NOT_EXISTS);
+    if ((boards_count == 0u) ||
+        (builder.failed == true))
+    {
+        free(builder.stream);
+        return false;
+    }
+
+    QueensPermutations_FileWriter_t writer;
+    if (QueensPermutations_FileWriterOpen(&writer, board_size, NULL) == false)
+    {
+        assert(false);
+        free(builder.stream);
+        return false;
+    }
+
+    QueensPermutations_FileWriterPutBytes(&writer, builder.stream, (size_t)((builder.bits_count + 7u) / 8u));
+    free(builder.stream);
+
+    debug_print("Prefix tree for board size %u: %llu boards in %llu bytes\n", board_size, (unsigned long long)boards_count, (unsigned long long)writer.header.payload_size);
+
+    return QueensPermutations_FileWriterClose(&writer, boards_count, boards_count);
+}
+
+/* writes node and its subtrees, returns number of boards below the node (nothing is written if 0) */
+static uint64 QueensPermutations_TreeBuildNode(QueensPermutations_TreeBuilder_t* builder, const uint8 column, const uint16 used_rows, const sint8 previous_row)
+{
+    if (column == builder->board_size)
+    {
+        return 1u;
+    }
+
+    const uint16 admissible_rows = QueensPermutations_GetAdmissibleRows(builder->board_size, column, used_rows, previous_row);
+    const uint8 bits_count = (uint8)__builtin_popcount(admissible_rows);
+    const uint64 node_pos = builder->bits_count;
+
+    if ((bits_count > 1u) &&
+        (QueensPermutations_TreeBuilderReserve(builder, bits_count) == false))
+    {
+        return 0u;
+    }
+
+    uint64 boards_count = 0u;
+    uint8 bit_idx = 0u;
+
+    for (uint16 rows = admissible_rows; rows != 0u; rows &= (uint16)(rows - 1u), bit_idx++)
+    {
+        const sint8 row = (sint8)__builtin_ctz(rows);
+        const uint64 child_pos = builder->bits_count;
+        const uint64 child_boards_count = QueensPermutations_TreeBuildNode(builder, column + 1u, (uint16)(used_rows | (1u << row)), row);
+
+        if (child_boards_count == 0u)
+        {
+            /* dead end, drop whatever the child has written */
+            QueensPermutations_TreeBuilderRollback(builder, child_pos);
+            continue;
+        }
+
+        boards_count += child_boards_count;
+
+        if (bits_count > 1u)
+        {
+            const uint64 bit_pos = node_pos + bit_idx;
+            builder->stream[bit_pos / 8u] |= (uint8)(0x80u >> (bit_pos % 8u));
+        }
+    }
+
+    return boards_count;
+}
+
+static bool QueensPermutations_TreeBuilderReserve(QueensPermutations_TreeBuilder_t* builder, const uint64 bits_count)
+{
+    const size_t required_size = (size_t)((builder->bits_count + bits_count + 7u) / 8u);
+
+    if (required_size > builder->capacity)
+    {
+        const size_t new_capacity = (builder->capacity * 2u > required_size) ? (builder->capacity * 2u) : (required_size + QUEENS_PERMUTATIONS_FILE_BLOCK_SIZE);
+        uint8* new_stream = realloc(builder->stream, new_capacity);
+        if (new_stream == NULL)
+        {
+            assert(false);
+            builder->failed = true;
+            return false;
+        }
+
+        /* node bits are set in place, so the stream has to start zeroed */
+        memset(&new_stream[builder->capacity], 0, new_capacity - builder->capacity);
+        builder->stream = new_stream;
+        builder->capacity = new_capacity;
+    }
+
+    builder->bits_count += bits_count;
+
+    return true;
+}
+
+static void QueensPermutations_TreeBuilderRollback(QueensPermutations_TreeBuilder_t* builder, const uint64 bits_count)
+{
+    size_t first_byte = (size_t)(bits_count / 8u);
+    const size_t end_byte = (size_t)((builder->bits_count + 7u) / 8u);
+
+    if ((bits_count % 8u) != 0u)
+    {
+        builder->stream[first_byte] &= (uint8)(0xFFu << (8u - (bits_count % 8u)));
+        first_byte++;
+    }
+
+    if (end_byte > first_byte)
+    {
+        memset(&builder->stream[first_byte], 0, end_byte - first_byte);
+    }
+
+    builder->bits_count = bits_count;
+}
+
+/* walker starts at node given by prefix, bit_pos points at that node in the stream */
+static void QueensPermutations_TreeWalkerInit(QueensPermutations_TreeWalker_t* walker, const uint8* const stream, const size_t stream_size, const QueensPermutation_BoardSize_t board_size, const QueensPermutations_QueenRowIndex_t* const prefix, const uint8 prefix_len, const uint64 bit_pos)
+{
+    *walker = (QueensPermutations_TreeWalker_t){ 0 };
+    walker->stream = stream;
+    walker->stream_size = stream_size;
+    walker->bit_pos = bit_pos;
+    walker->board_size = board_size;
+    walker->root_depth = prefix_len;
+    walker->depth = prefix_len;
+
+    for (uint8 column = 0u; column < prefix_len; column++)
+    {
+        walker->board[column] = prefix[column];
+        walker->used_rows[column + 1u] = (uint16)(walker->used_rows[column] | (1u << prefix[column]));
+    }
+
+    walker->children[prefix_len] = QueensPermutations_TreeReadChildren(walker);
+}
+
+/* moves one edge further in depth-first order (queen placed in walker->board[column]), false once subtree of the root is exhausted */
+static bool QueensPermutations_TreeWalkerStep(QueensPermutations_TreeWalker_t* walker, uint8* const column)
+{
+    while (walker->children[walker->depth] == 0u)
+    {
+        if (walker->depth == walker->root_depth)
+        {
+            return false;
+        }
+
+        walker->depth--;
+    }
+
+    const uint8 depth = walker->depth;
+    const uint16 children = walker->children[depth];
+    const sint8 row = (sint8)__builtin_ctz(children);
+
+    walker->children[depth] = (uint16)(children & (children - 1u));
+    walker->board[depth] = row;
+    walker->used_rows[depth + 1u] = (uint16)(walker->used_rows[depth] | (1u << row));
+    *column = depth;
+
+    if ((depth + 1u) < walker->board_size)
+    {
+        walker->depth++;
+        walker->children[walker->depth] = QueensPermutations_TreeReadChildren(walker);
+    }
+
+    return true;
+}
+
+/* skips everything below the node entered by the last step, only node bits are read */
+static void QueensPermutations_TreeWalkerSkipSubtree(QueensPermutations_TreeWalker_t* walker)
+{
+    const uint8 root_depth = walker->root_depth;
+    uint8 column;
+
+    walker->root_depth = walker->depth;
+    while (QueensPermutations_TreeWalkerStep(walker, &column) == true)
+    {
+    }
+
+    walker->root_depth = root_depth;
+}
+
+static bool QueensPermutations_TreeWalkerNext(QueensPermutations_TreeWalker_t* walker, QueensPermutations_QueenRowIndex_t* const board)
+{
+    uint8 column;
+
+    while (QueensPermutations_TreeWalkerStep(walker, &column) == true)
+    {
+        if ((column + 1u) == walker->board_size)
+        {
+            memcpy(board, walker->board, walker->board_size * sizeof(QueensPermutations_QueenRowIndex_t));
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* reads node at walker->depth, returns bitmask of rows of its children */
+static uint16 QueensPermutations_TreeReadChildren(QueensPermutations_TreeWalker_t* walker)
+{
+    const uint8 depth = walker->depth;
+    const sint8 previous_row = (depth > 0u) ? walker->board[depth - 1u] : QUEEN_ROW_NOT_EXISTS;
+    const uint16 admissible_rows = QueensPermutations_GetAdmissibleRows(walker->board_size, depth, walker->used_rows[depth], previous_row);
+    const uint8 bits_count = (uint8)__builtin_popcount(admissible_rows);
+
+    if (bits_count <= 1u)
+    {
+        return admissible_rows;
+    }
+
+    /* 3 bytes cover up to 7 bits of offset plus 15 bits of the node */
+    const size_t byte_idx = (size_t)(walker->bit_pos / 8u);
+    uint32 window = 0u;
+
+    for (size_t i = 0u; i < 3u; i++)
+    {
+        window <<= 8u;
+        if ((byte_idx + i) < walker->stream_size)
+        {
+            window |= walker->stream[byte_idx + i];
+        }
+    }
+
+    const uint32 bits = (window >> (24u - (walker->bit_pos % 8u) - bits_count)) & ((1u << bits_count) - 1u);
+    walker->bit_pos += bits_count;
+
+    uint16 children = 0u;
+    uint8 bit_idx = 0u;
+
+    for (uint16 rows = admissible_rows; rows != 0u; rows &= (uint16)(rows - 1u), bit_idx++)
+    {
+        if ((bits & (1u << (bits_count - 1u - bit_idx))) != 0u)
+        {
+            children |= (uint16)(rows & -rows);
+        }
+    }
+
+    return children;
+}
+
+static inline uint16 QueensPermutations_GetAdmissibleRows(const QueensPermutation_BoardSize_t board_size, const uint8 column, const uint16 used_rows, const sint8 previous_row)
+{
+    uint16 rows = (uint16)(((1u << board_size) - 1u) & ~used_rows);
+
+    /* queens in adjacent columns can't be in adjacent rows */
+    if (column > 0u)
+    {
+        const uint32 previous_row_bit = 1u << previous_row;
+        rows &= (uint16)~((previous_row_bit << 1u) | (previous_row_bit >> 1u));
+    }
+
+    return rows;
+}
+
+/* filename NULL - cached file of given board size */
+static bool QueensPermutations_FileWriterOpen(QueensPermutations_FileWriter_t* writer, const QueensPermutation_BoardSize_t board_size, const char* const filename)
+{
+    *writer = (QueensPermutations_FileWriter_t){ 0 };
+    writer->header.magic = QUEENS_PERMUTATIONS_FILE_MAGIC;
+    writer->header.version = QUEENS_PERMUTATIONS_FILE_VERSION;
+    writer->header.board_size = board_size;
+    writer->header.encoding = (uint8)QueensPermutations_GetConfiguredEncoding();
+    writer->header.block_size = QUEENS_PERMUTATIONS_FILE_BLOCK_SIZE;
+
+    if (filename != NULL)
+    {
+        (void)snprintf(writer->filename, sizeof(writer->filename), "%s", filename);
+    }
+    else if (QueensPermutations_GetFilename(board_size, writer->filename) == false)
+    {
+        return false;
+    }
+
+    /* readers never see partially written file, it appears under its name only once complete */
+    if (snprintf(writer->temp_filename, sizeof(writer->temp_filename), "%s.XXXXXX", writer->filename) >= (int)sizeof(writer->temp_filename))
+    {
+        return false;
+    }
+
+    const int fd = mkstemp(writer->temp_filename);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    /* mkstemp creates the file accessible only to its owner, cache is shared */
+    (void)fchmod(fd, 0644);
+
+    writer->file = fdopen(fd, "wb");
+    if (writer->file == NULL)
+    {
+        close(fd);
+        (void)remove(writer->temp_filename);
+        return false;
+    }
+
+    /* counts are not known upfront, header is rewritten once payload is complete */
+    writer->write_failed = (fwrite(&writer->header, sizeof(writer->header), 1, writer->file) != 1u);
+
+    return true;
+}
+
+static void QueensPermutations_FileWriterPutNibble(QueensPermutations_FileWriter_t* writer, const uint8 nibble)
+{
+    /* higher nibble first */
+    if (writer->lower_nibble == false)
+    {
+        writer->buffer[writer->buffer_idx] = (uint8)(nibble << NIBBLE_LEN);
+    }
+    else
+    {
+        writer->buffer[writer->buffer_idx] |= (nibble & 0b1111);
+        writer->buffer_idx++;
+
+        if (writer->buffer_idx >= sizeof(writer->buffer))
+        {
+            writer->buffer_idx = 0u;
+            QueensPermutations_FileWriterPutBytes(writer, writer->buffer, sizeof(writer->buffer));
+        }
+    }
+
+    writer->lower_nibble = !writer->lower_nibble;
+}
+
+static void QueensPermutations_FileWriterPutBytes(QueensPermutations_FileWriter_t* writer, const void* const data, const size_t length)
+{
+    (void)QueensPermutations_BlockCrcUpdate(&writer->block_crc, (const uint8*)data, length);
+    if (fwrite(data, 1u, length, writer->file) != length)
+    {
+        writer->write_failed = true;
+    }
+    writer->header.payload_size += length;
+}
+
+/* drops everything written so far, nothing is published */
+static void QueensPermutations_FileWriterAbort(QueensPermutations_FileWriter_t* writer)
+{
+    (void)fclose(writer->file);
+    free(writer->block_crc.block_crcs);
+    (void)remove(writer->temp_filename);
+}
+
+static bool QueensPermutations_FileWriterClose(QueensPermutations_FileWriter_t* writer, const uint64 boards_count, const uint64 records_count)
+{
+    /* include last number if stored only in higher nibble */
+    if (writer->lower_nibble == true)
+    {
+        writer->buffer_idx++;
+        writer->lower_nibble = false;
+    }
+
+    QueensPermutations_FileWriterPutBytes(writer, writer->buffer, writer->buffer_idx);
+    bool success = QueensPermutations_BlockCrcFinish(&writer->block_crc) && (writer->write_failed == false);
+
+    /* block CRCs follow the payload, header goes at the very beginning */
+    writer->header.boards_count = boards_count;
+    writer->header.records_count = records_count;
+    writer->header.header_crc = QueensPermutations_GetHeaderCrc(&writer->header);
+
+    /* empty payload has no blocks, block_crcs is not allocated then */
+    success = success &&
+              ((writer->block_crc.blocks_count == 0u) ||
+               (fwrite(writer->block_crc.block_crcs, sizeof(uint16), (size_t)writer->block_crc.blocks_count, writer->file) == writer->block_crc.blocks_count));
+    success = success && (fseek(writer->file, 0, SEEK_SET) == 0);
+    success = success && (fwrite(&writer->header, sizeof(writer->header), 1, writer->file) == 1u);
+    success = (fclose(writer->file) == 0) && success;
+
+    free(writer->block_crc.block_crcs);
+
+    /* rename replaces the cached file atomically, readers see either the old file or the complete new one */
+    success = success && (rename(writer->temp_filename, writer->filename) == 0);
+
+    if (success == false)
+    {
+        (void)remove(writer->temp_filename);
+    }
+
+    return success;
+}
+
+/* opens permutations file and checks its header in O(1), NULL if file doesn't exist or can't be used */
+static FILE* QueensPermutations_OpenValidatedFile(const QueensPermutation_BoardSize_t board_size, QueensPermutations_FileHeader_t* header)
+{
+    char filename[PATH_MAX];
+    if (QueensPermutations_GetFilename(board_size, filename) == false)
+    {
+        return NULL;
+    }
+
+    return QueensPermutations_OpenValidatedFileAt(filename, board_size, header);
+}
+
+static FILE* QueensPermutations_OpenValidatedFileAt(const char* const filename, const QueensPermutation_BoardSize_t board_size, QueensPermutations_FileHeader_t* header)
+{
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL)
+    {
+        return NULL;
+    }
+
+    struct stat file_stat;
+    bool valid = (fstat(fileno(file), &file_stat) == 0) &&
+                 (fread(header, sizeof(QueensPermutations_FileHeader_t), 1, file) == 1u);
+
+    valid = valid &&
+            (header->magic == QUEENS_PERMUTATIONS_FILE_MAGIC) &&
+            (header->version == QUEENS_PERMUTATIONS_FILE_VERSION) &&
+            (header->header_crc == QueensPermutations_GetHeaderCrc(header)) &&
+            (header->board_size == board_size) &&
+            (header->encoding == (uint8)QueensPermutations_GetConfiguredEncoding()) &&
+            (header->block_size == QUEENS_PERMUTATIONS_FILE_BLOCK_SIZE) &&
+            ((header->encoding == QUEENS_PERMUTATIONS_ENCODING_TREE) ||
+             (header->payload_size == QueensPermutations_GetPayloadSize((QueensPermutations_Encoding_t)header->encoding, board_size, header->records_count)));
+
+    if (valid == true)
+    {
+        /* file that was cut short (e.g. interrupted write) */
+        const uint64 blocks_count = (header->payload_size + header->block_size - 1u) / header->block_size;
+        valid = ((uint64)file_stat.st_size == (sizeof(QueensPermutations_FileHeader_t) + header->payload_size + blocks_count * sizeof(uint16)));
+    }
+
+    if (valid == false)
+    {
+        debug_print("Permutations file %s is corrupted or stale, it will be regenerated\n", filename);
+        fclose(file);
+        return NULL;
+    }
+
+    /* file position is at the beginning of the payload */
+    return file;
+}
+
+static bool QueensPermutations_ReadBlockCrcs(FILE* file, const QueensPermutations_FileHeader_t* const header, QueensPermutations_BlockCrc_t* block_crc)
+{
+    /* file position is preserved */
+    const long position = ftell(file);
+
+    *block_crc = (QueensPermutations_BlockCrc_t){ 0 };
+    block_crc->verify = true;
+    block_crc->blocks_count = (header->payload_size + header->block_size - 1u) / header->block_size;
+    block_crc->block_crcs = malloc((size_t)block_crc->blocks_count * sizeof(uint16) + 1u);
+
+    bool success = (block_crc->block_crcs != NULL) &&
+                   (fseek(file, (long)(sizeof(QueensPermutations_FileHeader_t) + header->payload_size), SEEK_SET) == 0) &&
+                   (fread(block_crc->block_crcs, sizeof(uint16), (size_t)block_crc->blocks_count, file) == block_crc->blocks_count) &&
+                   (fseek(file, position, SEEK_SET) == 0);
+
+    if (success == false)
+    {
+        free(block_crc->block_crcs);
+        block_crc->block_crcs = NULL;
+    }
+
+    return success;
+}
+
+/* when writing appends CRC of every completed block, when verifying returns false on first mismatch */
+static bool QueensPermutations_BlockCrcUpdate(QueensPermutations_BlockCrc_t* block_crc, const uint8* data, size_t length)
+{
+    while (length > 0u)
+    {
+        if (block_crc->block_fill == 0u)
+        {
+            block_crc->crc = CRC_CalculateCRC16(NULL, 0u);
+        }
+
+        size_t chunk_length = QUEENS_PERMUTATIONS_FILE_BLOCK_SIZE - block_crc->block_fill;
+        if (chunk_length > length)
+        {
+            chunk_length = length;
+        }
+
+        block_crc->crc = CRC_UpdateCRC16(block_crc->crc, data, chunk_length);
+        block_crc->block_fill += (uint32)chunk_length;
+        data += chunk_length;
+        length -= chunk_length;
+
+        if ((block_crc->block_fill == QUEENS_PERMUTATIONS_FILE_BLOCK_SIZE) &&
+            (QueensPermutations_BlockCrcFinish(block_crc) == false))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* closes current (possibly partial) block */
+static bool QueensPermutations_BlockCrcFinish(QueensPermutations_BlockCrc_t* block_crc)
+{
+    if (block_crc->block_fill == 0u)
+    {
+        return true;
+    }
+
+    block_crc->block_fill = 0u;
+
+    if (block_crc->verify == true)
+    {
+        return (block_crc->block_idx < block_crc->blocks_count) &&
+               (block_crc->block_crcs[block_crc->block_idx++] == block_crc->crc);
+    }
+
+    if (block_crc->block_idx == block_crc->blocks_capacity)
+    {
+        const uint64 blocks_capacity = block_crc->blocks_capacity * 2u + 16u;
+        uint16* block_crcs = realloc(block_crc->block_crcs, (size_t)blocks_capacity * sizeof(uint16));
+        if (block_crcs == NULL)
+        {
+            return false;
+        }
+
+        block_crc->block_crcs = block_crcs;
+        block_crc->blocks_capacity = blocks_capacity;
+    }
+
+    block_crc->block_crcs[block_crc->block_idx++] = block_crc->crc;
+    block_crc->blocks_count = block_crc->block_idx;
+
+    return true;
+}
+
+/* filename NULL - cached file of given board size */
+static QueensPermutations_Result_t QueensPermutations_LoadAllFromFile(const QueensPermutation_BoardSize_t board_size, const char* const filename)
+{
+    QueensPermutations_Result_t result = { 0 };
+    result.board_size = board_size;
+    result.success = false;
+
+    QueensPermutations_FileHeader_t header;
+    FILE *file = (filename != NULL) ? QueensPermutations_OpenValidatedFileAt(filename, board_size, &header) : QueensPermutations_OpenValidatedFile(board_size, &header);
+    if (file == NULL)
+    {
+        return result;
+    }
+
+    /* retrieve number of boards */
+    result.boards_count = header.boards_count;
+    result.prefix_tree = (header.encoding == QUEENS_PERMUTATIONS_ENCODING_TREE);
+    result.tree_size = result.prefix_tree ? (size_t)header.payload_size : 0u;
+
+    result.packed = (header.encoding == QUEENS_PERMUTATIONS_ENCODING_NIBBLE) && (global_config.permutations_keep_packed == true);
+
+    /* prefix tree and packed boards are kept as they are stored */
+    const size_t single_board_alloc_size = sizeof(QueensPermutations_QueenRowIndex_t) * board_size;
+    const bool keep_payload = (result.prefix_tree == true) || (result.packed == true);
+    result.boards = malloc(keep_payload ? ((size_t)header.payload_size + 1u) : (single_board_alloc_size*result.boards_count));
+    if (result.boards == NULL)
+    {
+        assert(false);
+        fclose(file);
+        return result;
+    }
+
+    /* large tables are unpacked by many threads, that needs packed payload in separate buffer */
+    const bool unpack = (header.encoding == QUEENS_PERMUTATIONS_ENCODING_NIBBLE) && (result.packed == false);
+    const bool unpack_in_parallel = unpack &&
+                                    (header.payload_size >= QUEENS_PERMUTATIONS_PARALLEL_UNPACK_MIN_SIZE) &&
+                                    (global_config.permutations_unpack_threads != 1u);
+    uint8* payload = unpack_in_parallel ? malloc((size_t)header.payload_size) : (uint8*)result.boards;
+
+    if ((payload == NULL) ||
+        (fread(payload, 1u, (size_t)header.payload_size, file) != header.payload_size) ||
+        (QueensPermutations_VerifyPayload(file, &header, payload) == false))
+    {
+        fclose(file);
+        if (payload != (uint8*)result.boards)
+        {
+            free(payload);
+        }
+        free(result.boards);
+        result.boards = NULL;
+        return result;
+    }
+
+    fclose(file);
+    result.success = true;
+
+    const size_t columns_count = (size_t)result.boards_count * board_size;
+
+    if (unpack_in_parallel == true)
+    {
+        Nibble_UnpackParallel((uint8*)result.boards, payload, 0u, columns_count, global_config.permutations_unpack_threads);
+        free(payload);
+    }
+    else if (unpack == true)
+    {
+        /* expands in place, from the end */
+        Nibble_Unpack((uint8*)result.boards, (const uint8*)result.boards, 0u, columns_count);
+    }
+
+    return result;
+}
+
+static QueensPermutations_Result_t QueensPermutations_MapAllFromFile(const QueensPermutation_BoardSize_t board_size, const char* const filename)
+{
+    QueensPermutations_Result_t result = { 0 };
+    result.board_size = board_size;
+    result.success = false;
+
+    /* header check makes sure the file is not truncated before handing out pointers into it */
+    QueensPermutations_FileHeader_t header;
+    FILE *file = (filename != NULL) ? QueensPermutations_OpenValidatedFileAt(filename, board_size, &header) : QueensPermutations_OpenValidatedFile(board_size, &header);
+    if (file == NULL)
+    {
+        return result;
+    }
+
+    const size_t mapping_size = sizeof(QueensPermutations_FileHeader_t) + (size_t)header.payload_size;
+
+    /* mapping stays valid after the file is closed, pages are shared between all processes mapping the same file */
+    void* mapping = mmap(NULL, mapping_size, PROT_READ, MAP_SHARED, fileno(file), 0);
+
+    /* payload is checked once before any pointer into it is handed out, it faults in every page same as prefault would */
+    if ((mapping != MAP_FAILED) &&
+        (QueensPermutations_VerifyPayload(file, &header, (const uint8*)mapping + sizeof(QueensPermutations_FileHeader_t)) == false))
+    {
+        (void)munmap(mapping, mapping_size);
+        mapping = MAP_FAILED;
+    }
+
+    fclose(file);
+
+    if (mapping == MAP_FAILED)
+    {
+        return result;
+    }
+
+    result.mapping = mapping;
+    result.mapping_size = mapping_size;
+    result.boards = (QueensPermutations_QueenRowIndex_t*)((uint8*)mapping + sizeof(QueensPermutations_FileHeader_t));
+    result.boards_count = header.boards_count;
+    result.packed = (header.encoding == QUEENS_PERMUTATIONS_ENCODING_NIBBLE);
+    result.prefix_tree = (header.encoding == QUEENS_PERMUTATIONS_ENCODING_TREE);
+    result.tree_size = result.prefix_tree ? (size_t)header.payload_size : 0u;
+    result.success = true;
+
+    return result;
+}
+
+/* checks payload (already read into memory) against block CRCs stored in the file */
+static bool QueensPermutations_VerifyPayload(FILE* file, const QueensPermutations_FileHeader_t* const header, const uint8* const payload)
+{
+    QueensPermutations_BlockCrc_t block_crc;
+    if (QueensPermutations_ReadBlockCrcs(file, header, &block_crc) == false)
+    {
+        return false;
+    }
+
+    bool valid = QueensPermutations_BlockCrcUpdate(&block_crc, payload, (size_t)header->payload_size) &&
+                 QueensPermutations_BlockCrcFinish(&block_crc) &&
+                 (block_crc.block_idx == block_crc.blocks_count);
+
+    free(block_crc.block_crcs);
+
+    if (valid == false)
+    {
+        debug_print("Permutations file for board size %u doesn't match its checksums\n", header->board_size);
+    }
+
+    return valid;
+}
+
+/* checks whole payload against block CRCs, it is read block by block from the current file position */
+static bool QueensPermutations_VerifyFile(FILE* file, const QueensPermutations_FileHeader_t* const header)
+{
+    QueensPermutations_BlockCrc_t block_crc;
+    if (QueensPermutations_ReadBlockCrcs(file, header, &block_crc) == false)
+    {
+        return false;
+    }
+
+    uint8* block = malloc(QUEENS_PERMUTATIONS_FILE_BLOCK_SIZE);
+    if (block == NULL)
+    {
+        assert(false);
+        free(block_crc.block_crcs);
+        return false;
+    }
+
+    bool valid = true;
+
+    for (uint64 left_size = header->payload_size; (valid == true) && (left_size > 0u); )
+    {
+        const size_t read_size = (left_size < QUEENS_PERMUTATIONS_FILE_BLOCK_SIZE) ? (size_t)left_size : QUEENS_PERMUTATIONS_FILE_BLOCK_SIZE;
+        valid = (fread(block, 1u, read_size, file) == read_size) &&
+                QueensPermutations_BlockCrcUpdate(&block_crc, block, read_size);
+        left_size -= read_size;
+    }
+
+    valid = valid &&
+            QueensPermutations_BlockCrcFinish(&block_crc) &&
+            (block_crc.block_idx == block_crc.blocks_count);
+
+    free(block);
+    free(block_crc.block_crcs);
+
+    return valid;
+}
+
+static uint16 QueensPermutations_GetHeaderCrc(const QueensPermutations_FileHeader_t* const header)
+{
+    QueensPermutations_FileHeader_t header_copy = *header;
+    header_copy.header_crc = 0u;
+
+    return CRC_CalculateCRC16((const uint8*)&header_copy, sizeof(header_copy));
+}
+
+static uint64 QueensPermutations_GetPayloadSize(const QueensPermutations_Encoding_t encoding, const QueensPermutation_BoardSize_t board_size, const uint64 records_count)
+{
+    switch (encoding)
+    {
+        case QUEENS_PERMUTATIONS_ENCODING_RAW:
+            return records_count * board_size;
+        case QUEENS_PERMUTATIONS_ENCODING_NIBBLE:
+            return (records_count * board_size + 1u) / 2u;
+        case QUEENS_PERMUTATIONS_ENCODING_SYMMETRIC:
+            return (records_count * (board_size + QUEENS_PERMUTATIONS_ORBIT_CODE_NIBBLES) + 1u) / 2u;
+        case QUEENS_PERMUTATIONS_ENCODING_TREE:
+            return 0u; /* depends on the shape of the tree, not only on the number of boards */
+    }
+
+    return 0u;
+}
+
+static QueensPermutations_Encoding_t QueensPermutations_GetConfiguredEncoding(void)
+{
+    if (global_config.permutations_symmetry_reduced == true)
+    {
+        return QUEENS_PERMUTATIONS_ENCODING_SYMMETRIC;
+    }
+
+    if (global_config.permutations_prefix_tree == true)
+    {
+        return QUEENS_PERMUTATIONS_ENCODING_TREE;
+    }
+
+    if (global_config.permutations_compressed == true)
+    {
+        return QUEENS_PERMUTATIONS_ENCODING_NIBBLE;
+    }
+
+    return QUEENS_PERMUTATIONS_ENCODING_RAW;
+}
+
+static void QueensPermutations_Compress(QueensPermutations_Result_t* result)
+{
+    /* packing goes front to back, packed byte never overtakes columns still to be read */
+    const size_t columns_count = (size_t)result->board_size * result->boards_count;
+    uint8* const packed = (uint8*)result->boards;
+
+    for (size_t column_idx = 0u; column_idx < columns_count; column_idx += 2u)
+    {
+        const uint8 higher_nibble = (uint8)result->boards[column_idx];
+        const uint8 lower_nibble = ((column_idx + 1u) < columns_count) ? (uint8)result->boards[column_idx + 1u] : 0u;
+        packed[column_idx / 2u] = (uint8)((higher_nibble << NIBBLE_LEN) | lower_nibble);
+    }
+
+    result->packed = true;
+
+    /* give back the upper half */
+    QueensPermutations_QueenRowIndex_t* boards = realloc(result->boards, (columns_count + 1u) / 2u);
+    if (boards != NULL)
+    {
+        result->boards = boards;
+    }
+}
+
+[[maybe_unused]] QueensPermutations_Result_t QueensPermutations_Generate(const QueensPermutation_BoardSize_t board_size, uint8 threads_count)
+{
+    QueensPermutations_Result_t result = { 0 };
+    result.success = false;
+    result.board_size = board_size;
+
+    if ((board_size < QUEENS_MIN_BOARD_SIZE) ||
+        (board_size > QUEENS_MAX_BOARD_SIZE))
+    {
+        return result;
+    }
+
+    /*
+        enumeration is split by the row of the queen in column 0. Completion counts give the size of every first row's slice up front,
+        so the table is allocated once and every first row is expanded straight into its slice. Slices in first row order give
+        exactly the same board order as single-threaded expansion, and nothing but the table itself is held
+    */
+    QueensPermutations_GenerateJob_t job = { 0 };
+    job.board_size = board_size;
+    atomic_init(&job.next_first_row, 0u);
+    atomic_init(&job.failed, false);
+
+    uint64 boards_count = 0u;
+    uint64* const completion_counts = QueensPermutations_BuildCompletionCounts(board_size, &boards_count);
+    if (completion_counts == NULL)
+    {
         return result;
     }
 
-    assert(sizeof(QueensPermutations_QueenRowIndex_t) == 1u);
+    for (uint8 first_row = 0u; first_row < board_size; first_row++)
+    {
+        job.first_row_offsets[first_row + 1u] = job.first_row_offsets[first_row] + completion_counts[(size_t)(1u << first_row) * board_size + first_row];
+    }
+    assert(job.first_row_offsets[board_size] == boards_count);
+    free(completion_counts);
 
-    /* check if file with board permutations has already been generated */
-    /* if not, create it first */
+    job.boards = malloc(sizeof(QueensPermutations_QueenRowIndex_t) * board_size * boards_count);
+    if (job.boards == NULL)
+    {
+        assert(false);
+        return result;
+    }
 
-    FILE *file = QueensPermutations_OpenPermutationsFile(board_size, "rb");
-    if (file == NULL)
+    /* every thread claims first rows from the shared job, there are only board_size of them */
+    ThreadPool_Run(QueensPermutations_GenerateWorker, &job, 0u, ThreadPool_GetThreadsCount(threads_count, board_size));
+
+    if (atomic_load(&job.failed) == true)
     {
-        /* file doesn't exist */
-        result = QueensPermutations_Generate(board_size);
+        assert(false);
+        free(job.boards);
+        return result;
+    }
+
+    result.boards = job.boards;
+    result.boards_count = boards_count;
+    result.success = true;
+
+    return result;
+}
 
-        bool write_success = QueensPermutations_SaveToFile(&result);
-        assert(write_success == true);
+static void* QueensPermutations_GenerateWorker(void* arg)
+{
+    QueensPermutations_GenerateJob_t* job = (QueensPermutations_GenerateJob_t*)arg;
 
-        bool free_success = QueensPermutations_FreeResult(&result);
-        assert(free_success == true);
+    for (;;)
+    {
+        const uint32 first_row = atomic_fetch_add(&job->next_first_row, 1u);
+        if (first_row >= job->board_size)
+        {
+            break;
+        }
 
-        /* now that permutations are generated, open file again */
-        file = QueensPermutations_OpenPermutationsFile(board_size, "rb");
-        assert(file != NULL);
+        const uint64 offset = job->first_row_offsets[first_row];
+        if (QueensPermutations_GenerateFromFirstRow(job->board_size, (sint8)first_row, &job->boards[offset * job->board_size], job->first_row_offsets[first_row + 1u] - offset) == false)
+        {
+            atomic_store(&job->failed, true);
+        }
     }
 
-    result.board_size = board_size;
-    result.success = false;
-    result.boards_count = 1u;
+    return NULL;
+}
 
-    result.boards = malloc(board_size * sizeof(QueensPermutations_QueenRowIndex_t));
-    if (result.boards == NULL)
+/* expected number of boards start with given first row, false if enumeration disagrees with completion counts */
+static bool QueensPermutations_GenerateFromFirstRow(const QueensPermutation_BoardSize_t board_size, const sint8 first_row, QueensPermutations_QueenRowIndex_t* const boards, const uint64 boards_count)
+{
+    QueensPermutations_Enumerator_t enumerator;
+    QueensPermutations_EnumeratorInit(&enumerator, board_size, &first_row, 1u);
+
+    /* every completed permutation is written straight into its place in the table, enumerator itself is O(board_size) */
+    for (uint64 board_idx = 0u; board_idx < boards_count; board_idx++)
     {
-        assert(false);
-        return result;
+        if (QueensPermutations_EnumeratorNext(&enumerator, &boards[board_idx * board_size]) == false)
+        {
+            return false;
+        }
     }
 
-    uint32 file_boards_count;
-    fread(&file_boards_count, sizeof(file_boards_count), 1, file);
+    /* slice is full, enumeration has to be done as well */
+    QueensPermutations_QueenRowIndex_t extra_board[QUEENS_MAX_BOARD_SIZE];
+    return (QueensPermutations_EnumeratorNext(&enumerator, extra_board) == false);
+}
 
-    uint32 random_board_offset = 0u;
+static void QueensPermutations_EnumeratorInit(QueensPermutations_Enumerator_t* enumerator, const QueensPermutation_BoardSize_t board_size, const QueensPermutations_QueenRowIndex_t* const prefix, const uint8 prefix_len)
+{
+    assert(prefix_len < board_size);
 
-    if (global_config.permutations_compressed == true)
-    {
-        uint32 file_elements_read_count = QueensPermutations_RoundUpDiv(board_size, 2u);
-        uint32 random_board_num = RNG_RandomRange_u32(0u, file_boards_count-1u);
-        random_board_offset = (uint32)sizeof(file_boards_count) + random_board_num * (uint32)board_size / 2u;
+    enumerator->board_size = board_size;
+    enumerator->prefix_len = prefix_len;
+    enumerator->column = prefix_len;
+    enumerator->used_rows[0] = 0u;
 
-        /* scenario where board size is odd */
-        bool board_starts_from_middle_of_byte = ((random_board_num % 2u) != 0u);
+    const uint16 all_rows = (uint16)((1u << board_size) - 1u);
+    uint16 candidates = all_rows;
 
-        /* for even board sizes, this is always false */
-        if (board_size % 2u == 0u)
+    /* fixed prefix has to be legal on its own, otherwise there is nothing to enumerate */
+    for (uint8 column = 0u; column < prefix_len; column++)
+    {
+        const uint16 row_bit = (uint16)(1u << prefix[column]);
+        if ((candidates & row_bit) == 0u)
         {
-            board_starts_from_middle_of_byte = false;
+            candidates = 0u;
+            break;
         }
 
-        fseek(file, random_board_offset, SEEK_SET);
-        fread(result.boards, sizeof(QueensPermutations_QueenRowIndex_t), file_elements_read_count, file);
+        enumerator->board[column] = prefix[column];
+        enumerator->used_rows[column + 1u] = enumerator->used_rows[column] | row_bit;
+        candidates = all_rows & (uint16)~(enumerator->used_rows[column + 1u] | (uint16)(row_bit << 1u) | (uint16)(row_bit >> 1u));
+    }
+
+    enumerator->candidates[prefix_len] = candidates;
+}
+
+static bool QueensPermutations_EnumeratorNext(QueensPermutations_Enumerator_t* enumerator, QueensPermutations_QueenRowIndex_t* const board)
+{
+    const uint8 last_column = (uint8)(enumerator->board_size - 1u);
+    const uint16 all_rows = (uint16)((1u << enumerator->board_size) - 1u);
+
+    /*
+        depth-first search, rows are tried from the lowest one - gives the same (lexicographic) order as the old breadth-first expansion.
+        candidates[column] holds rows not tried yet in given column: not used by previous columns and not diagonally adjacent to previous queen
+    */
+    for (;;)
+    {
+        const uint8 column = enumerator->column;
+        const uint16 candidates = enumerator->candidates[column];
 
-        if (board_starts_from_middle_of_byte == true)
+        if (candidates == 0u)
         {
-            /* board starts from the middle of a byte, shift all elements one nibble to the left for proper decompression alignment */
-            for (size_t i = 0; i < board_size - 1; i++) {
-                result.boards[i] = (QueensPermutations_QueenRowIndex_t)(
-                    ((uint8_t)result.boards[i] << NIBBLE_LEN) | ((uint8_t)result.boards[i + 1] >> NIBBLE_LEN)
-                );
+            if (column == enumerator->prefix_len)
+            {
+                return false;
             }
-            result.boards[board_size - 1] = (QueensPermutations_QueenRowIndex_t)(
-                (uint8_t)result.boards[board_size - 1] << NIBBLE_LEN
-            );
 
+            enumerator->column--;
+            continue;
         }
 
-        QueensPermutations_Decompress(&result);
-    }
-    else
-    {
-        /* first 4 bytes is for boards count, needs to be offset */
-        random_board_offset = (uint32)sizeof(file_boards_count) + (RNG_RandomRange_u32(0u, file_boards_count-1u) * board_size);
-        fseek(file, random_board_offset, SEEK_SET);
-        fread(result.boards, sizeof(QueensPermutations_QueenRowIndex_t), result.board_size, file);
-    }
+        const uint8 row = (uint8)__builtin_ctz(candidates);
+        const uint16 row_bit = (uint16)(1u << row);
+        enumerator->candidates[column] = candidates & (uint16)(candidates - 1u);
+        enumerator->board[column] = (QueensPermutations_QueenRowIndex_t)row;
 
-    fclose(file);
-    result.success = true;
+        if (column == last_column)
+        {
+            memcpy(board, enumerator->board, enumerator->board_size * sizeof(QueensPermutations_QueenRowIndex_t));
+            return true;
+        }
 
-    return result; /* has to be freed by the caller (QueensPermutations_FreeResult) */
+        enumerator->used_rows[column + 1u] = enumerator->used_rows[column] | row_bit;
+        enumerator->candidates[column + 1u] = all_rows & (uint16)~(enumerator->used_rows[column + 1u] | (uint16)(row_bit << 1u) | (uint16)(row_bit >> 1u));
+        enumerator->column++;
+    }
 }
 
-[[maybe_unused]] QueensPermutations_Result_t QueensPermutations_GetAll(const QueensPermutation_BoardSize_t board_size)
+QueensPermutations_Cursor_t* QueensPermutations_CursorOpen(const QueensPermutation_BoardSize_t board_size, const QueensPermutations_CursorSource_t source)
 {
-    QueensPermutations_Result_t result = { 0 };
-
     if ((board_size < QUEENS_MIN_BOARD_SIZE) ||
         (board_size > QUEENS_MAX_BOARD_SIZE))
     {
-        result.success = false;
-        return result;
+        return NULL;
     }
 
+    /* batch size is even, so every packed batch starts at byte boundary */
+    static_assert((QUEENS_PERMUTATIONS_CURSOR_BATCH_SIZE % 2u) == 0u);
 
-    assert(sizeof(QueensPermutations_QueenRowIndex_t) == 1u);
+    QueensPermutations_Cursor_t* cursor = calloc(1u, sizeof(QueensPermutations_Cursor_t));
+    if (cursor == NULL)
+    {
+        return NULL;
+    }
 
-    /* check if file with board permutation has already been generated */
-    /* if yes, load from file. If no, generate new one and save to file */
+    cursor->board_size = board_size;
+    cursor->boards = malloc((size_t)QUEENS_PERMUTATIONS_CURSOR_BATCH_SIZE * board_size * sizeof(QueensPermutations_QueenRowIndex_t));
+    if (cursor->boards == NULL)
+    {
+        free(cursor);
+        return NULL;
+    }
 
-    FILE *file = QueensPermutations_OpenPermutationsFile(board_size, "rb");
-    if (file != NULL)
+    QueensPermutations_FileHeader_t header;
+
+    if (source != QUEENS_PERMUTATIONS_CURSOR_SOURCE_ENUMERATOR)
     {
-        /* file exists */
-        fclose(file);
-        result = QueensPermutations_LoadAllFromFile(board_size);
+        cursor->file = QueensPermutations_OpenValidatedFile(board_size, &header);
+
+        if ((cursor->file == NULL) &&
+            (source == QUEENS_PERMUTATIONS_CURSOR_SOURCE_FILE))
+        {
+            if (QueensPermutations_BuildFile(board_size) == true)
+            {
+                cursor->file = QueensPermutations_OpenValidatedFile(board_size, &header);
+            }
+
+            if (cursor->file == NULL)
+            {
+                QueensPermutations_CursorClose(cursor);
+                return NULL;
+            }
+        }
+    }
+
+    if (cursor->file != NULL)
+    {
+        cursor->file_packed = (header.encoding != QUEENS_PERMUTATIONS_ENCODING_RAW);
+        cursor->file_symmetric = (header.encoding == QUEENS_PERMUTATIONS_ENCODING_SYMMETRIC);
+        cursor->file_tree = (header.encoding == QUEENS_PERMUTATIONS_ENCODING_TREE);
+        cursor->file_boards_left = header.records_count; /* symmetric file - count records instead of boards */
+        cursor->file_buffer = malloc((size_t)QUEENS_PERMUTATIONS_CURSOR_BATCH_SIZE * board_size);
+
+        if ((cursor->file_buffer == NULL) ||
+            (QueensPermutations_ReadBlockCrcs(cursor->file, &header, &cursor->block_crc) == false))
+        {
+            QueensPermutations_CursorClose(cursor);
+            return NULL;
+        }
+
+        if (cursor->file_tree == true)
+        {
+            /* tree is streamed through file_buffer window, it is walked the same way as when fully loaded */
+            cursor->file_boards_left = header.payload_size;
+            cursor->tree_walker.stream = cursor->file_buffer;
+            QueensPermutations_CursorRefillTree(cursor);
+            QueensPermutations_TreeWalkerInit(&cursor->tree_walker, cursor->file_buffer, cursor->tree_walker.stream_size, board_size, NULL, 0u, 0u);
+        }
     }
     else
     {
-        /* file doesn't exist */
-        result = QueensPermutations_Generate(board_size);
-        bool write_success = QueensPermutations_SaveToFile(&result);
-        assert(write_success == true);
+        QueensPermutations_EnumeratorInit(&cursor->enumerator, board_size, NULL, 0u);
     }
 
-    return result; /* has to be freed by the caller (QueensPermutations_FreeResult) */
+    return cursor;
 }
 
-static bool QueensPermutations_SaveToFile(const QueensPermutations_Result_t* const result)
+bool QueensPermutations_CursorNextBatch(QueensPermutations_Cursor_t* cursor, QueensPermutations_Result_t* batch)
 {
-    if (result == NULL)
-    {
-        assert(false);
-        return false;
-    }
+    assert(cursor != NULL);
+    assert(batch != NULL);
 
-    FILE *file = QueensPermutations_OpenPermutationsFile(result->board_size, "wb");
-    if (file == NULL)
-    {
-        assert(false);
-        return false;
-    }
+    *batch = (QueensPermutations_Result_t){ 0 };
+    batch->board_size = cursor->board_size;
+    batch->boards = cursor->boards;
 
-    /* first write how many boards are there */
-    fwrite(&result->boards_count, sizeof(result->boards_count), 1, file);
+    uint32 boards_count = 0u;
 
-    /* then the actual boards */
-    if (global_config.permutations_compressed == true)
+    if ((cursor->file != NULL) &&
+        (cursor->file_symmetric == true))
     {
-        constexpr size_t BUFFER_SIZE = 128u;
-        QueensPermutations_QueenRowIndex_t buffer[BUFFER_SIZE] = { 0u };
-        bool lower_nibble = false;
-        size_t buffer_idx = 0u;
+        /* batch of records is even, every batch starts at byte boundary */
+        static_assert((QUEENS_PERMUTATIONS_CURSOR_BATCH_RECORDS % 2u) == 0u);
+
+        const uint32 records_count = (cursor->file_boards_left < QUEENS_PERMUTATIONS_CURSOR_BATCH_RECORDS) ? (uint32)cursor->file_boards_left : QUEENS_PERMUTATIONS_CURSOR_BATCH_RECORDS;
+        const size_t bytes_count = ((size_t)records_count * (cursor->board_size + QUEENS_PERMUTATIONS_ORBIT_CODE_NIBBLES) + 1u) / 2u;
 
-        for (size_t column_idx = 0u; column_idx < (result->board_size*result->boards_count); column_idx++)
+        cursor->file_boards_left -= records_count;
+        if (QueensPermutations_CursorRead(cursor, cursor->file_buffer, bytes_count) == false)
         {
+            return false;
+        }
 
-            if (lower_nibble == false)
+        boards_count = (uint32)QueensPermutations_ExpandSymmetricRecords(cursor->file_buffer, records_count, cursor->board_size, cursor->boards);
+    }
+    else if ((cursor->file != NULL) &&
+             (cursor->file_tree == true))
+    {
+        uint8 column;
+
+        while ((boards_count < QUEENS_PERMUTATIONS_CURSOR_BATCH_SIZE) &&
+               (cursor->failed == false))
+        {
+            QueensPermutations_CursorRefillTree(cursor);
+            if (QueensPermutations_TreeWalkerStep(&cursor->tree_walker, &column) == false)
             {
-                buffer[buffer_idx] |= (result->boards[column_idx] << NIBBLE_LEN);
+                break;
             }
-            else
-            {
-                buffer[buffer_idx] |= (result->boards[column_idx] & 0b1111);
-                buffer_idx++;
 
-                if (buffer_idx >= BUFFER_SIZE)
-                {
-                    fwrite(buffer, sizeof(QueensPermutations_QueenRowIndex_t), BUFFER_SIZE, file);
-                    memset(buffer, 0, BUFFER_SIZE);
-                    buffer_idx = 0u;
-                }
+            if ((column + 1u) == cursor->board_size)
+            {
+                memcpy(&cursor->boards[(size_t)boards_count * cursor->board_size], cursor->tree_walker.board, cursor->board_size * sizeof(QueensPermutations_QueenRowIndex_t));
+                boards_count++;
             }
-
-            lower_nibble = !lower_nibble;
         }
 
-        /* include last number if stored only in higher nibble */
-        if (lower_nibble == true)
+        if (cursor->failed == true)
         {
-            buffer_idx++;
+            return false;
         }
+    }
+    else if (cursor->file != NULL)
+    {
+        boards_count = (cursor->file_boards_left < QUEENS_PERMUTATIONS_CURSOR_BATCH_SIZE) ? (uint32)cursor->file_boards_left : QUEENS_PERMUTATIONS_CURSOR_BATCH_SIZE;
+        const size_t columns_count = (size_t)boards_count * cursor->board_size;
+        cursor->file_boards_left -= boards_count;
 
-        fwrite(buffer, sizeof(QueensPermutations_QueenRowIndex_t), buffer_idx, file);
+        if (cursor->file_packed == true)
+        {
+            const size_t bytes_count = (columns_count + 1u) / 2u;
+            if (QueensPermutations_CursorRead(cursor, cursor->file_buffer, bytes_count) == false)
+            {
+                return false;
+            }
 
+            Nibble_Unpack((uint8*)cursor->boards, cursor->file_buffer, 0u, columns_count);
+        }
+        else if (QueensPermutations_CursorRead(cursor, (uint8*)cursor->boards, columns_count) == false)
+        {
+            return false;
+        }
     }
     else
     {
-        fwrite(result->boards, sizeof(QueensPermutations_QueenRowIndex_t), result->board_size*result->boards_count, file);
+        while ((boards_count < QUEENS_PERMUTATIONS_CURSOR_BATCH_SIZE) &&
+               (QueensPermutations_EnumeratorNext(&cursor->enumerator, &cursor->boards[(size_t)boards_count * cursor->board_size]) == true))
+        {
+            boards_count++;
+        }
     }
 
+    batch->boards_count = boards_count;
+    batch->success = (boards_count > 0u);
 
-    fclose(file);
-
-    return true;
+    return batch->success;
 }
 
-static QueensPermutations_Result_t QueensPermutations_LoadAllFromFile(const QueensPermutation_BoardSize_t board_size)
+bool QueensPermutations_CursorFailed(const QueensPermutations_Cursor_t* cursor)
 {
-    QueensPermutations_Result_t result;
-    result.board_size = board_size;
-    result.success = false;
+    return cursor->failed;
+}
 
-    FILE *file = QueensPermutations_OpenPermutationsFile(board_size, "rb");
-    if (file == NULL)
+void QueensPermutations_CursorClose(QueensPermutations_Cursor_t* cursor)
+{
+    if (cursor == NULL)
     {
-        assert(false);
-        return result;
+        return;
     }
 
-    /* retrieve number of boards */
-    fread(&result.boards_count, sizeof(result.boards_count), 1, file);
-    const size_t single_board_alloc_size = sizeof(QueensPermutations_QueenRowIndex_t) * board_size;
-    result.boards = malloc(single_board_alloc_size*result.boards_count);
-    if (result.boards == NULL)
+    if (cursor->file != NULL)
     {
-        assert(false);
-        return result;
+        fclose(cursor->file);
     }
 
-    fread(result.boards, sizeof(QueensPermutations_QueenRowIndex_t), result.board_size*result.boards_count, file);
+    free(cursor->block_crc.block_crcs);
+    free(cursor->file_buffer);
+    free(cursor->boards);
+    free(cursor);
+}
 
-    fclose(file);
-    result.success = true;
+/* reads next chunk of payload and checks it against block CRCs */
+static bool QueensPermutations_CursorRead(QueensPermutations_Cursor_t* cursor, uint8* const buffer, const size_t length)
+{
+    bool valid = (fread(buffer, 1u, length, cursor->file) == length) &&
+                 QueensPermutations_BlockCrcUpdate(&cursor->block_crc, buffer, length);
 
-    if (global_config.permutations_compressed == true)
+    /* last partial block is complete once all records are read (counter is updated before reading) */
+    if ((valid == true) &&
+        (cursor->file_boards_left == 0u))
     {
-        QueensPermutations_Decompress(&result);
+        valid = QueensPermutations_BlockCrcFinish(&cursor->block_crc);
     }
 
-    return result;
+    if (valid == false)
+    {
+        /* corrupted file, drop it so that it gets regenerated on next use */
+        debug_print("Permutations file for board size %u doesn't match its checksums\n", cursor->board_size);
+        cursor->file_boards_left = 0u;
+        cursor->failed = true;
+        (void)QueensPermutations_RemoveCorruptedFile(cursor->board_size);
+    }
+
+    return valid;
 }
 
-static void QueensPermutations_Decompress(QueensPermutations_Result_t* result)
+/* keeps at least QUEENS_PERMUTATIONS_TREE_LOOKAHEAD_BYTES of the tree ahead of the walker, more than any single step reads */
+static void QueensPermutations_CursorRefillTree(QueensPermutations_Cursor_t* cursor)
 {
-    /* function assumes that result->boards has enough size for decompressed array */
+    QueensPermutations_TreeWalker_t* walker = &cursor->tree_walker;
+    const size_t consumed_size = (size_t)(walker->bit_pos / 8u);
+    const size_t left_size = walker->stream_size - consumed_size;
 
-    /* start from the end to avoid temporaries */
-    const size_t last_column_idx = (result->board_size * result->boards_count);
-    size_t column_compressed_idx = QueensPermutations_RoundUpDiv((uint32)last_column_idx, 2u) - 1;
-    bool lower_nibble = true;
-    /* if last number contains two columns, start from lower nibble. Otherwise, start from higher nibble */
-    if ((column_compressed_idx - (last_column_idx / 2u)) == 0u)
+    if ((left_size >= QUEENS_PERMUTATIONS_TREE_LOOKAHEAD_BYTES) ||
+        (cursor->file_boards_left == 0u))
     {
-        lower_nibble = false;
+        return;
     }
 
-    for (size_t column_idx = last_column_idx; column_idx-- > 0u;)
+    const size_t window_size = (size_t)QUEENS_PERMUTATIONS_CURSOR_BATCH_SIZE * cursor->board_size;
+    const size_t read_size = ((window_size - left_size) < cursor->file_boards_left) ? (window_size - left_size) : (size_t)cursor->file_boards_left;
+
+    memmove(cursor->file_buffer, &cursor->file_buffer[consumed_size], left_size);
+    walker->bit_pos -= (uint64)consumed_size * 8u;
+    walker->stream_size = left_size;
+
+    cursor->file_boards_left -= read_size;
+    if (QueensPermutations_CursorRead(cursor, &cursor->file_buffer[left_size], read_size) == true)
     {
-        if (lower_nibble == true)
-        {
-            result->boards[column_idx] = (QueensPermutations_QueenRowIndex_t)(
-                (uint8_t)(result->boards[column_compressed_idx] & 0b1111)
-            );
-        }
-        else
-        {
-            result->boards[column_idx] = (QueensPermutations_QueenRowIndex_t)(
-                (uint8_t)(result->boards[column_compressed_idx] >> NIBBLE_LEN)
-            );
-            column_compressed_idx--;
-        }
+        walker->stream_size += read_size;
+    }
+}
 
-        /* Ensure the value is correctly interpreted as unsigned */
-        result->boards[column_idx] &= 0x0F;
+[[maybe_unused]] bool QueensPermutations_FreeResult(const QueensPermutations_Result_t* result)
+{
+    if (result->mapping != NULL)
+    {
+        return (munmap(result->mapping, result->mapping_size) == 0);
+    }
 
-        lower_nibble = !lower_nibble;
+    if ((result->boards != NULL) &&
+        (result->success == true))
+    {
+        free(result->boards);
     }
+
+    return true;
 }
 
-static QueensPermutations_Result_t QueensPermutations_Generate(const QueensPermutation_BoardSize_t board_size)
+QueensPermutations_Result_t QueensPermutations_ToColumnMajor(const QueensPermutations_Result_t* const table)
 {
-    QueensPermutations_Result_t result;
-    result.success = false;
-    result.board_size = board_size;
-    result.boards_count = 1u; /* one empty board */
-    uint32 new_board_candidates = 0u;
-    const size_t single_board_alloc_size = sizeof(QueensPermutations_QueenRowIndex_t) * board_size;
-    uint64 boards_capacity = single_board_alloc_size * board_size * BOARDS_INIT_MALLOC_FACTOR;
-    result.boards = malloc(boards_capacity);
+    QueensPermutations_Result_t result = { 0 };
+    result.board_size = table->board_size;
+
+    if ((table->success == false) ||
+        (table->prefix_tree == true))
+    {
+        return result;
+    }
 
+    result.boards = malloc((size_t)table->boards_count * table->board_size);
     if (result.boards == NULL)
     {
         assert(false);
         return result;
     }
 
-    memset(result.boards, QUEEN_ROW_NOT_EXISTS, boards_capacity);
+    QueensPermutations_QueenRowIndex_t board_buffer[QUEENS_MAX_BOARD_SIZE];
 
-    /*
-        algorithm:
-        1. Start with single, empty board
-        2. on every column iteration, attempt placing queen in every row
-        3. If placement is legal, create a copy of parent board with newly added queen and append new board at the end of the list
-        4. Move newly created boards at the beginning of the list, get rid of older iterations
-    */
-    for (sint8 column_idx = 0; column_idx < board_size; column_idx++)
+    for (uint64 board_idx = 0u; board_idx < table->boards_count; board_idx++)
     {
-        new_board_candidates = 0u;
+        const QueensPermutations_QueenRowIndex_t* queens = QueensPermutations_GetBoard(table, board_idx, board_buffer);
 
-        for (size_t board_idx = 0u; board_idx < result.boards_count; board_idx++)
+        for (uint8 column = 0u; column < table->board_size; column++)
         {
-            for (sint8 row_idx = 0; row_idx < board_size; row_idx++)
-            {
-
-                if (QueensPermutations_IsQueenPlacementLegal(&result.boards[board_size*board_idx], board_size, column_idx, row_idx) == true)
-                {
-                    while((board_size*(result.boards_count+new_board_candidates) + board_size) >= boards_capacity)
-                    {
-                        /* no more space for new boards, increase boards capacity 2x */
-                        boards_capacity *= 2u;
-                        result.boards = (QueensPermutations_QueenRowIndex_t*)realloc(result.boards, boards_capacity);
-                        if (result.boards == NULL)
-                        {
-                            assert(false);
-                            return result;
-                        }
-                        memset(&result.boards[boards_capacity/2], QUEEN_ROW_NOT_EXISTS, boards_capacity/2);
-                    }
-
-                    /* create new board at the end of boards list */
-                    memmove(&result.boards[board_size*(result.boards_count+new_board_candidates)], &result.boards[board_size*board_idx], single_board_alloc_size);
-
-                    /* add queen to new board */
-                    result.boards[(uint32)board_size*(result.boards_count+new_board_candidates) + (uint32)column_idx] = row_idx;
-                    ++new_board_candidates;
-                }
-            }
+            result.boards[(size_t)column * table->boards_count + board_idx] = queens[column];
         }
+    }
+
+    result.boards_count = table->boards_count;
+    result.column_major = true;
+    result.success = true;
+
+    return result;
+}
+
+/*
+    advisory lock on <permutations file>.lock serialising cache creation between processes (and threads).
+    waited is set if the lock was held by someone else - cached file has most likely just been published
+*/
+static int QueensPermutations_LockCache(const QueensPermutation_BoardSize_t board_size, bool* const waited)
+{
+    char filename[PATH_MAX];
+    char lock_filename[PATH_MAX];
+
+    *waited = false;
 
-        /* move all the elements from this iteration to the beginning and discard old ones */
-        memmove(result.boards, &result.boards[board_size*result.boards_count], single_board_alloc_size*new_board_candidates);
-        result.boards_count = new_board_candidates;
-        new_board_candidates = 0u;
+    /* lock of a truncated name wouldn't serialise anything, file itself can't be opened either */
+    if ((QueensPermutations_GetFilename(board_size, filename) == false) ||
+        (snprintf(lock_filename, sizeof(lock_filename), "%s.lock", filename) >= (int)sizeof(lock_filename)))
+    {
+        return -1;
     }
 
+    if (global_config.permutations_cache_dir != NULL)
+    {
+        /* only the last level is created, EEXIST is the common case */
+        (void)mkdir(global_config.permutations_cache_dir, 0755);
+    }
 
-    /* algorithm done, get rid of redundant memory */
-    result.boards = (QueensPermutations_QueenRowIndex_t*)realloc(result.boards, single_board_alloc_size*result.boards_count);
+    const int lock_fd = open(lock_filename, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (lock_fd < 0)
+    {
+        /* cache can't be locked (e.g. read-only directory), go on without it */
+        debug_print("Permutations cache lock %s can't be opened\n", lock_filename);
+        return -1;
+    }
 
-    if (result.boards == NULL)
+    if (flock(lock_fd, LOCK_EX | LOCK_NB) == 0)
     {
-        assert(false);
-        return result;
+        return lock_fd;
     }
 
-    result.success = true;
+    *waited = true;
 
-    return result;
-}
+    int lock_result;
+    do
+    {
+        lock_result = flock(lock_fd, LOCK_EX);
+    } while ((lock_result != 0) && (errno == EINTR));
 
-[[maybe_unused]] bool QueensPermutations_FreeResult(const QueensPermutations_Result_t* result)
-{
-    if ((result->boards != NULL) &&
-        (result->success == true))
+    if (lock_result != 0)
     {
-        free(result->boards);
+        close(lock_fd);
+        return -1;
     }
 
-    return true;
+    return lock_fd;
 }
 
-static bool QueensPermutations_IsQueenPlacementLegal(const QueensPermutations_QueenRowIndex_t* const board, const QueensPermutation_BoardSize_t board_size, const sint8 dest_column, const sint8 dest_row)
+static void QueensPermutations_UnlockCache(const int lock_fd)
 {
-    assert(dest_column >= 0        );
-    assert(dest_column < board_size);
-    assert(dest_row    >= 0        );
-    assert(dest_row    < board_size);
+    /* lock file itself stays, removing it would let next process lock a different inode */
+    if (lock_fd >= 0)
+    {
+        (void)flock(lock_fd, LOCK_UN);
+        close(lock_fd);
+    }
+}
 
-    /* no queen in the same column */
-    if (board[dest_column] != QUEEN_ROW_NOT_EXISTS)
+/* prefix NULL - manifest of the shards */
+static bool QueensPermutations_GetShardFilename(const QueensPermutation_BoardSize_t board_size, const QueensPermutations_QueenRowIndex_t* const prefix, const char* const extension, char* destination_filename)
+{
+    char filename[PATH_MAX];
+    if (QueensPermutations_GetFilename(board_size, filename) == false)
     {
         return false;
     }
 
-    /* no queen in the same row */
-    for (sint8 column_idx = 0; column_idx < board_size; column_idx++)
+    /* drop ".bin", shard suffix goes before it */
+    filename[strlen(filename) - 4u] = '\0';
+
+    /* truncated name would point to another file */
+    const int length = (prefix == NULL) ? snprintf(destination_filename, PATH_MAX, "%s_manifest%s", filename, extension) :
+                                          snprintf(destination_filename, PATH_MAX, "%s_%02u%02u%s", filename, (unsigned)prefix[0], (unsigned)prefix[1], extension);
+
+    return (length >= 0) && (length < PATH_MAX);
+}
+
+/* true if cached file was removed, it may have been replaced by other process since it was found corrupted */
+static bool QueensPermutations_RemoveCorruptedFile(const QueensPermutation_BoardSize_t board_size)
+{
+    char filename[PATH_MAX];
+    if (QueensPermutations_GetFilename(board_size, filename) == false)
     {
-        if (board[column_idx] == dest_row)
-        {
-            return false;
-        }
+        return false;
     }
 
-    /* no queens in the neighboring diagonals */
-    for (sint8 column_idx = dest_column - 1; column_idx <= dest_column + 1; column_idx++)
-    {
-        if (column_idx < 0 || column_idx >= board_size)
-        {
-            continue; // Skip out-of-bounds columns
-        }
+    bool waited = false;
+    const int lock_fd = QueensPermutations_LockCache(board_size, &waited);
 
-        sint8 existing_row = board[column_idx];
-        if (existing_row != QUEEN_ROW_NOT_EXISTS)
-        {
-            /* Check if the neighboring square is diagonally adjacent */
-            if (abs(existing_row - dest_row) == 1) // Difference in row is 1
-            {
-                return false;
-            }
-        }
+    /* stale header is regenerated by the build path anyway, only a file that still doesn't match its checksums is removed */
+    QueensPermutations_FileHeader_t header;
+    FILE* file = QueensPermutations_OpenValidatedFileAt(filename, board_size, &header);
+    bool removed = false;
+
+    if (file != NULL)
+    {
+        const bool valid = QueensPermutations_VerifyFile(file, &header);
+        fclose(file);
+        removed = (valid == false) && (remove(filename) == 0);
     }
 
-    return true;
+    QueensPermutations_UnlockCache(lock_fd);
+
+    return removed;
 }
 
-static FILE* QueensPermutations_OpenPermutationsFile(QueensPermutation_BoardSize_t board_size, const char* mode)
+static bool QueensPermutations_GetFilename(QueensPermutation_BoardSize_t board_size, char* destination_filename)
 {
     /* prepare filename */
-    char destination_filename[QueensPermutations_filename_strlen];
-    strcpy(destination_filename, QueensPermutations_filename);
+    char filename[QueensPermutations_filename_strlen];
+    strcpy(filename, QueensPermutations_filename);
 
     /* compose board size into filename */
-    destination_filename[QueensPermutations_filename_first_X_pos]  = (char)(board_size/10u) + '0';
-    destination_filename[QueensPermutations_filename_second_X_pos] = (char)(board_size%10u) + '0';
+    filename[QueensPermutations_filename_first_X_pos]  = (char)(board_size/10u) + '0';
+    filename[QueensPermutations_filename_second_X_pos] = (char)(board_size%10u) + '0';
 
-    if (global_config.permutations_compressed == true)
+    if (global_config.permutations_symmetry_reduced == true)
     {
-        destination_filename[QueensPermutations_filename_third_X_pos] = 'c';
+        /* canonical boards with orbit codes, always nibble-packed */
+        filename[QueensPermutations_filename_third_X_pos] = 's';
+    }
+    else if (global_config.permutations_prefix_tree == true)
+    {
+        filename[QueensPermutations_filename_third_X_pos] = 't';
+    }
+    else if (global_config.permutations_compressed == true)
+    {
+        filename[QueensPermutations_filename_third_X_pos] = 'c';
     }
     else
     {
-        destination_filename[QueensPermutations_filename_third_X_pos] = 'n';
+        filename[QueensPermutations_filename_third_X_pos] = 'n';
     }
 
+    /* no directory - current working directory */
+    if (global_config.permutations_cache_dir == NULL)
+    {
+        strcpy(destination_filename, filename);
+        return true;
+    }
 
-    return fopen(destination_filename, mode);
-}
+    /* truncated name would point to another file */
+    const int length = snprintf(destination_filename, PATH_MAX, "%s/%s", global_config.permutations_cache_dir, filename);
 
-/* example: QueensPermutations_RoundUpDiv(15, 2) == 8 */
-static inline uint32 QueensPermutations_RoundUpDiv(uint32 num, uint32 div)
-{
-    return ((num + div - 1u) / div);
+    return (length >= 0) && (length < PATH_MAX);
 }
@@ -0,0 +1,388 @@
+#include <queens_permutations_index.h>
+#include <global_config.h>
+#include <debug_print.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/* leading columns whose queens define permutation group instead of having bitmaps */
+constexpr uint8 QUEENS_PERMUTATIONS_INDEX_PREFIX_LEN = 2u;
+/* permutations per bitmap word */
+constexpr uint8 QUEENS_PERMUTATIONS_INDEX_WORD_BITS = 64u;
+
+/* permutations starting with the same rows, every group starts at word boundary */
+typedef struct
+{
+    QueensPermutations_QueenRowIndex_t rows[QUEENS_PERMUTATIONS_INDEX_PREFIX_LEN];
+    uint64 first_word;
+    uint64 words_count;
+} QueensPermutationsIndex_Group_t;
+
+struct QueensPermutationsIndex
+{
+    uint64* words;                           /* words_count x cells_count, bitmaps of all cells for one word of permutations are adjacent */
+    uint64 words_count;
+    QueensPermutationsIndex_Group_t* groups;
+    uint32 groups_count;
+    uint16 cells_count;                      /* cells of non-prefix columns, cell (row, column) is at (column - prefix len) * board_size + row */
+    QueensPermutation_BoardSize_t board_size;
+};
+
+typedef struct
+{
+    QueensPermutationsIndex_t* index;
+    uint32 references_count;
+    bool dropped;                            /* freed on last release */
+} QueensPermutationsIndex_Shared_t;
+
+static QueensPermutationsIndex_Shared_t QueensPermutationsIndex_shared[QUEENS_MAX_BOARD_SIZE + 1u];
+static pthread_mutex_t QueensPermutationsIndex_shared_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+QueensPermutationsIndex_t* QueensPermutationsIndex_Build(const QueensPermutation_BoardSize_t board_size)
+{
+    if ((board_size < QUEENS_MIN_BOARD_SIZE) ||
+        (board_size > QUEENS_MAX_BOARD_SIZE))
+    {
+        return NULL;
+    }
+
+    /* every group wastes less than one word, there are less than board_size^2 groups */
+    const uint64 max_words_count = (QueensPermutations_GetCount(board_size) / QUEENS_PERMUTATIONS_INDEX_WORD_BITS) + ((uint64)board_size * board_size) + 1u;
+    const uint16 cells_count = (uint16)(board_size * (board_size - QUEENS_PERMUTATIONS_INDEX_PREFIX_LEN));
+
+    QueensPermutationsIndex_t* index = calloc(1u, sizeof(QueensPermutationsIndex_t));
+    QueensPermutations_Cursor_t* cursor = QueensPermutations_CursorOpen(board_size, QUEENS_PERMUTATIONS_CURSOR_SOURCE_ENUMERATOR);
+
+    if ((index == NULL) || (cursor == NULL))
+    {
+        free(index);
+        QueensPermutations_CursorClose(cursor);
+        return NULL;
+    }
+
+    index->board_size = board_size;
+    index->cells_count = cells_count;
+    index->words = calloc((size_t)(max_words_count * cells_count), sizeof(uint64));
+    index->groups = calloc((size_t)board_size * board_size, sizeof(QueensPermutationsIndex_Group_t));
+
+    if ((index->words == NULL) || (index->groups == NULL))
+    {
+        assert(false);
+        QueensPermutations_CursorClose(cursor);
+        QueensPermutationsIndex_Free(index);
+        return NULL;
+    }
+
+    /* enumeration is in lexicographic order, permutations of one group come one after another */
+    QueensPermutationsIndex_Group_t* group = NULL;
+    QueensPermutations_QueenRowIndex_t board_buffer[QUEENS_MAX_BOARD_SIZE];
+    QueensPermutations_Result_t batch = { 0 };
+    uint64 word_idx = 0u;
+    uint8 bit_idx = 0u;
+
+    while (QueensPermutations_CursorNextBatch(cursor, &batch) == true)
+    {
+        for (uint64 board_idx = 0u; board_idx < batch.boards_count; board_idx++)
+        {
+            const QueensPermutations_QueenRowIndex_t* queens = QueensPermutations_GetBoard(&batch, board_idx, board_buffer);
+
+            if ((group == NULL) ||
+                (memcmp(group->rows, queens, QUEENS_PERMUTATIONS_INDEX_PREFIX_LEN) != 0))
+            {
+                if (bit_idx != 0u)
+                {
+                    word_idx++;
+                    bit_idx = 0u;
+                }
+
+                if (group != NULL)
+                {
+                    group->words_count = word_idx - group->first_word;
+                }
+
+                group = &index->groups[index->groups_count++];
+                memcpy(group->rows, queens, QUEENS_PERMUTATIONS_INDEX_PREFIX_LEN);
+                group->first_word = word_idx;
+            }
+
+            uint64* cells = &index->words[word_idx * cells_count];
+            const uint64 bit = 1ull << bit_idx;
+
+            for (uint8 column = QUEENS_PERMUTATIONS_INDEX_PREFIX_LEN; column < board_size; column++)
+            {
+                cells[(column - QUEENS_PERMUTATIONS_INDEX_PREFIX_LEN) * board_size + queens[column]] |= bit;
+            }
+
+            if (++bit_idx == QUEENS_PERMUTATIONS_INDEX_WORD_BITS)
+            {
+                word_idx++;
+                bit_idx = 0u;
+            }
+        }
+    }
+
+    const bool failed = QueensPermutations_CursorFailed(cursor);
+    QueensPermutations_CursorClose(cursor);
+
+    if ((failed == true) || (group == NULL))
+    {
+        QueensPermutationsIndex_Free(index);
+        return NULL;
+    }
+
+    index->words_count = word_idx + ((bit_idx != 0u) ? 1u : 0u);
+    group->words_count = index->words_count - group->first_word;
+
+    return index;
+}
+
+void QueensPermutationsIndex_Free(QueensPermutationsIndex_t* index)
+{
+    if (index == NULL)
+    {
+        return;
+    }
+
+    free(index->words);
+    free(index->groups);
+    free(index);
+}
+
+/*
+    permutation is a solution if every color has a queen: per color OR of its cells' bitmaps, AND over colors.
+    Colors with fewest cells go first, word is left as soon as the AND is empty
+*/
+uint32 QueensPermutationsIndex_CountSolutions(const QueensPermutationsIndex_t* const index, const QueensBoard_Board_t* const board, const uint32 max_solutions)
+{
+    const uint8 board_size = index->board_size;
+
+    if (board->board_size != board_size)
+    {
+        return 0u;
+    }
+
+    /* cells of every color in non-prefix columns */
+    uint8 color_cells[QUEENS_MAX_BOARD_SIZE + 1u][QUEENS_MAX_BOARD_SIZE * QUEENS_MAX_BOARD_SIZE];
+    uint8 color_cells_count[QUEENS_MAX_BOARD_SIZE + 1u] = { 0u };
+
+    for (uint8 column = QUEENS_PERMUTATIONS_INDEX_PREFIX_LEN; column < board_size; column++)
+    {
+        for (uint8 row = 0u; row < board_size; row++)
+        {
+            const uint8 color = QueensBoard_GetColor(board->board[IDX(row, column, board_size)]);
+            if ((color == COLOR_NONE) || (color > board_size))
+            {
+                return 0u;
+            }
+
+            color_cells[color][color_cells_count[color]++] = (uint8)((column - QUEENS_PERMUTATIONS_INDEX_PREFIX_LEN) * board_size + row);
+        }
+    }
+
+    uint8 colors_order[QUEENS_MAX_BOARD_SIZE];
+    for (uint8 color_idx = 0u; color_idx < board_size; color_idx++)
+    {
+        /* insertion by cells count, ascending */
+        uint8 position = color_idx;
+        while ((position > 0u) &&
+               (color_cells_count[colors_order[position - 1u]] > color_cells_count[color_idx + 1u]))
+        {
+            colors_order[position] = colors_order[position - 1u];
+            position--;
+        }
+
+        colors_order[position] = color_idx + 1u;
+    }
+
+    uint32 solutions_count = 0u;
+
+    for (uint32 group_idx = 0u; group_idx < index->groups_count; group_idx++)
+    {
+        const QueensPermutationsIndex_Group_t* group = &index->groups[group_idx];
+        const uint8 prefix_color_0 = QueensBoard_GetColor(board->board[IDX(group->rows[0], 0, board_size)]);
+        const uint8 prefix_color_1 = QueensBoard_GetColor(board->board[IDX(group->rows[1], 1, board_size)]);
+
+        /* prefix queens share a color - whole group is skipped */
+        if (prefix_color_0 == prefix_color_1)
+        {
+            continue;
+        }
+
+        /* remaining queens have to cover all other colors, each of them needs a cell outside prefix columns */
+        uint8 group_colors[QUEENS_MAX_BOARD_SIZE];
+        uint8 group_colors_count = 0u;
+        bool group_possible = true;
+
+        for (uint8 order_idx = 0u; order_idx < board_size; order_idx++)
+        {
+            const uint8 color = colors_order[order_idx];
+            if ((color != prefix_color_0) && (color != prefix_color_1))
+            {
+                group_possible = group_possible && (color_cells_count[color] > 0u);
+                group_colors[group_colors_count++] = color;
+            }
+        }
+
+        if (group_possible == false)
+        {
+            continue;
+        }
+
+        const uint64* cells = &index->words[group->first_word * index->cells_count];
+
+        for (uint64 word_idx = 0u; word_idx < group->words_count; word_idx++, cells += index->cells_count)
+        {
+            /* bits past the last permutation of a group have no queen on any cell, they drop out with the first color */
+            uint64 solutions = UINT64_MAX;
+
+            for (uint8 color_idx = 0u; (color_idx < group_colors_count) && (solutions != 0u); color_idx++)
+            {
+                const uint8 color = group_colors[color_idx];
+                uint64 covered = 0u;
+
+                for (uint8 cell_idx = 0u; cell_idx < color_cells_count[color]; cell_idx++)
+                {
+                    covered |= cells[color_cells[color][cell_idx]];
+                }
+
+                solutions &= covered;
+            }
+
+            if (solutions != 0u)
+            {
+                solutions_count += (uint32)__builtin_popcountll(solutions);
+                if (solutions_count >= max_solutions)
+                {
+                    return max_solutions;
+                }
+            }
+        }
+    }
+
+    return solutions_count;
+}
+
+size_t QueensPermutationsIndex_GetSize(const QueensPermutationsIndex_t* const index)
+{
+    return (size_t)(index->words_count * index->cells_count * sizeof(uint64)) +
+           (index->groups_count * sizeof(QueensPermutationsIndex_Group_t));
+}
+
+uint64 QueensPermutationsIndex_EstimateSize(const QueensPermutation_BoardSize_t board_size)
+{
+    if ((board_size < QUEENS_MIN_BOARD_SIZE) ||
+        (board_size > QUEENS_MAX_BOARD_SIZE))
+    {
+        return 0u;
+    }
+
+    /* allocated for the worst case of group padding */
+    const uint64 max_words_count = (QueensPermutations_GetCount(board_size) / QUEENS_PERMUTATIONS_INDEX_WORD_BITS) + ((uint64)board_size * board_size) + 1u;
+
+    return max_words_count * board_size * (board_size - QUEENS_PERMUTATIONS_INDEX_PREFIX_LEN) * sizeof(uint64);
+}
+
+const QueensPermutationsIndex_t* QueensPermutationsIndex_Acquire(const QueensPermutation_BoardSize_t board_size)
+{
+    if ((board_size < QUEENS_MIN_BOARD_SIZE) ||
+        (board_size > QUEENS_MAX_BOARD_SIZE))
+    {
+        return NULL;
+    }
+
+    const size_t budget = global_config.permutations_registry_budget;
+    if ((budget != 0u) &&
+        (QueensPermutationsIndex_EstimateSize(board_size) > budget))
+    {
+        return NULL;
+    }
+
+    QueensPermutationsIndex_Shared_t* shared = &QueensPermutationsIndex_shared[board_size];
+
+    pthread_mutex_lock(&QueensPermutationsIndex_shared_mutex);
+
+    if (shared->index == NULL)
+    {
+        shared->index = QueensPermutationsIndex_Build(board_size);
+        debug_print("Permutations index for board size %u built (%zu bytes)\n", board_size,
+                    (shared->index != NULL) ? QueensPermutationsIndex_GetSize(shared->index) : 0u);
+    }
+
+    const QueensPermutationsIndex_t* index = shared->index;
+    if (index != NULL)
+    {
+        shared->references_count++;
+        shared->dropped = false;
+    }
+
+    pthread_mutex_unlock(&QueensPermutationsIndex_shared_mutex);
+
+    return index;
+}
+
+void QueensPermutationsIndex_Release(const QueensPermutationsIndex_t* index)
+{
+    if (index == NULL)
+    {
+        return;
+    }
+
+    QueensPermutationsIndex_Shared_t* shared = &QueensPermutationsIndex_shared[index->board_size];
+    assert(index == shared->index);
+
+    pthread_mutex_lock(&QueensPermutationsIndex_shared_mutex);
+
+    assert(shared->references_count > 0u);
+    shared->references_count--;
+
+    if ((shared->dropped == true) &&
+        (shared->references_count == 0u))
+    {
+        QueensPermutationsIndex_Free(shared->index);
+        shared->index = NULL;
+        shared->dropped = false;
+    }
+
+    pthread_mutex_unlock(&QueensPermutationsIndex_shared_mutex);
+}
+
+void QueensPermutationsIndex_Drop(const QueensPermutation_BoardSize_t board_size)
+{
+    if ((board_size < QUEENS_MIN_BOARD_SIZE) ||
+        (board_size > QUEENS_MAX_BOARD_SIZE))
+    {
+        return;
+    }
+
+    QueensPermutationsIndex_Shared_t* shared = &QueensPermutationsIndex_shared[board_size];
+
+    pthread_mutex_lock(&QueensPermutationsIndex_shared_mutex);
+
+    if (shared->references_count == 0u)
+    {
+        QueensPermutationsIndex_Free(shared->index);
+        shared->index = NULL;
+    }
+    else
+    {
+        shared->dropped = (shared->index != NULL);
+    }
+
+    pthread_mutex_unlock(&QueensPermutationsIndex_shared_mutex);
+}
+
+void QueensPermutationsIndex_Clear(void)
+{
+    pthread_mutex_lock(&QueensPermutationsIndex_shared_mutex);
+
+    for (uint8 board_size = 0u; board_size <= QUEENS_MAX_BOARD_SIZE; board_size++)
+    {
+        assert(QueensPermutationsIndex_shared[board_size].references_count == 0u);
+        QueensPermutationsIndex_Free(QueensPermutationsIndex_shared[board_size].index);
+        QueensPermutationsIndex_shared[board_size].index = NULL;
+        QueensPermutationsIndex_shared[board_size].dropped = false;
+    }
+
+    pthread_mutex_unlock(&QueensPermutationsIndex_shared_mutex);
+}
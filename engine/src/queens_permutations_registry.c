@@ -0,0 +1,267 @@
+#include <queens_permutations_registry.h>
+#include <global_config.h>
+#include <debug_print.h>
+#include <assert.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+typedef enum
+{
+    QUEENS_PERMUTATIONS_REGISTRY_EMPTY = 0,
+    QUEENS_PERMUTATIONS_REGISTRY_LOADING = 1,  /* some thread is loading the table, others wait for it */
+    QUEENS_PERMUTATIONS_REGISTRY_READY = 2
+} QueensPermutationsRegistry_State_t;
+
+typedef struct
+{
+    QueensPermutations_Result_t table;
+    QueensPermutationsRegistry_State_t state;
+    uint32 references_count;
+    uint64 last_use;                           /* registry clock at last acquire, least recently used table is evicted first */
+    size_t size;
+} QueensPermutationsRegistry_Entry_t;
+
+static QueensPermutationsRegistry_Entry_t QueensPermutationsRegistry_entries[QUEENS_MAX_BOARD_SIZE + 1u];
+static QueensPermutationsRegistry_Stats_t QueensPermutationsRegistry_stats;
+static uint64 QueensPermutationsRegistry_clock;
+static pthread_mutex_t QueensPermutationsRegistry_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t QueensPermutationsRegistry_loaded = PTHREAD_COND_INITIALIZER;
+
+static void QueensPermutationsRegistry_EvictToBudget(void);
+static void QueensPermutationsRegistry_Evict(QueensPermutationsRegistry_Entry_t* entry);
+static size_t QueensPermutationsRegistry_GetTableSize(const QueensPermutations_Result_t* const table);
+static void QueensPermutationsRegistry_Prefault(const QueensPermutations_Result_t* const table);
+
+const QueensPermutations_Result_t* QueensPermutationsRegistry_Acquire(const QueensPermutation_BoardSize_t board_size)
+{
+    if ((board_size < QUEENS_MIN_BOARD_SIZE) ||
+        (board_size > QUEENS_MAX_BOARD_SIZE))
+    {
+        return NULL;
+    }
+
+    QueensPermutationsRegistry_Entry_t* entry = &QueensPermutationsRegistry_entries[board_size];
+
+    pthread_mutex_lock(&QueensPermutationsRegistry_mutex);
+
+    while (entry->state == QUEENS_PERMUTATIONS_REGISTRY_LOADING)
+    {
+        pthread_cond_wait(&QueensPermutationsRegistry_loaded, &QueensPermutationsRegistry_mutex);
+    }
+
+    if (entry->state == QUEENS_PERMUTATIONS_REGISTRY_READY)
+    {
+        QueensPermutationsRegistry_stats.hits++;
+    }
+    else
+    {
+        QueensPermutationsRegistry_stats.misses++;
+        entry->state = QUEENS_PERMUTATIONS_REGISTRY_LOADING;
+
+        /* loading may take long (or even generate the file), other sizes can be served meanwhile */
+        pthread_mutex_unlock(&QueensPermutationsRegistry_mutex);
+        QueensPermutations_Result_t table = QueensPermutations_GetAll(board_size);
+
+        if ((global_config.permutations_column_major == true) &&
+            (table.success == true) &&
+            (table.prefix_tree == false))
+        {
+            /* transposed table is used on its own, file layout isn't needed anymore */
+            const QueensPermutations_Result_t column_major_table = QueensPermutations_ToColumnMajor(&table);
+            (void)QueensPermutations_FreeResult(&table);
+            table = column_major_table;
+        }
+
+        pthread_mutex_lock(&QueensPermutationsRegistry_mutex);
+
+        if (table.success == true)
+        {
+            entry->table = table;
+            entry->size = QueensPermutationsRegistry_GetTableSize(&table);
+            entry->state = QUEENS_PERMUTATIONS_REGISTRY_READY;
+            QueensPermutationsRegistry_stats.resident_size += entry->size;
+        }
+        else
+        {
+            entry->state = QUEENS_PERMUTATIONS_REGISTRY_EMPTY;
+        }
+
+        pthread_cond_broadcast(&QueensPermutationsRegistry_loaded);
+    }
+
+    const QueensPermutations_Result_t* table = NULL;
+
+    if (entry->state == QUEENS_PERMUTATIONS_REGISTRY_READY)
+    {
+        entry->references_count++;
+        entry->last_use = ++QueensPermutationsRegistry_clock;
+        table = &entry->table;
+
+        /* newly loaded table may push others over the budget */
+        QueensPermutationsRegistry_EvictToBudget();
+    }
+
+    pthread_mutex_unlock(&QueensPermutationsRegistry_mutex);
+
+    return table;
+}
+
+void QueensPermutationsRegistry_Release(const QueensPermutations_Result_t* table)
+{
+    if (table == NULL)
+    {
+        return;
+    }
+
+    assert((table->board_size >= QUEENS_MIN_BOARD_SIZE) && (table->board_size <= QUEENS_MAX_BOARD_SIZE));
+    QueensPermutationsRegistry_Entry_t* entry = &QueensPermutationsRegistry_entries[table->board_size];
+    assert(table == &entry->table);
+
+    pthread_mutex_lock(&QueensPermutationsRegistry_mutex);
+
+    assert(entry->references_count > 0u);
+    entry->references_count--;
+
+    /* table kept over the budget only because it was in use */
+    QueensPermutationsRegistry_EvictToBudget();
+
+    pthread_mutex_unlock(&QueensPermutationsRegistry_mutex);
+}
+
+QueensPermutationsRegistry_Stats_t QueensPermutationsRegistry_GetStats(void)
+{
+    pthread_mutex_lock(&QueensPermutationsRegistry_mutex);
+
+    QueensPermutationsRegistry_Stats_t stats = QueensPermutationsRegistry_stats;
+    stats.budget = global_config.permutations_registry_budget;
+
+    pthread_mutex_unlock(&QueensPermutationsRegistry_mutex);
+
+    return stats;
+}
+
+void QueensPermutationsRegistry_Clear(void)
+{
+    pthread_mutex_lock(&QueensPermutationsRegistry_mutex);
+
+    for (uint8 board_size = QUEENS_MIN_BOARD_SIZE; board_size <= QUEENS_MAX_BOARD_SIZE; board_size++)
+    {
+        QueensPermutationsRegistry_Entry_t* entry = &QueensPermutationsRegistry_entries[board_size];
+
+        if ((entry->state == QUEENS_PERMUTATIONS_REGISTRY_READY) &&
+            (entry->references_count == 0u))
+        {
+            QueensPermutationsRegistry_Evict(entry);
+        }
+    }
+
+    pthread_mutex_unlock(&QueensPermutationsRegistry_mutex);
+}
+
+void QueensPermutationsRegistry_WarmUp(const uint32 board_sizes_mask)
+{
+    for (uint8 board_size = QUEENS_MIN_BOARD_SIZE; board_size <= QUEENS_MAX_BOARD_SIZE; board_size++)
+    {
+        /* sizes without full table are served by table-free paths, there is nothing to load */
+        if (((board_sizes_mask & (1u << board_size)) == 0u) ||
+            (QueensPermutations_TableFits(board_size) == false))
+        {
+            continue;
+        }
+
+        /* table stays loaded after release, until it is evicted over the budget */
+        const QueensPermutations_Result_t* table = QueensPermutationsRegistry_Acquire(board_size);
+        if (table == NULL)
+        {
+            debug_print("Permutations registry: warm-up of board size %u failed\n", board_size);
+            continue;
+        }
+
+        QueensPermutationsRegistry_Prefault(table);
+        QueensPermutationsRegistry_Release(table);
+    }
+}
+
+/* mapped table is read page by page, first scan of a cold mapping doesn't stall on page faults then */
+static void QueensPermutationsRegistry_Prefault(const QueensPermutations_Result_t* const table)
+{
+    if (table->mapping == NULL)
+    {
+        return;
+    }
+
+    (void)madvise(table->mapping, table->mapping_size, MADV_WILLNEED);
+
+    const long page_size = sysconf(_SC_PAGESIZE);
+    const volatile uint8* mapping = (const volatile uint8*)table->mapping;
+    uint8 checksum = 0u;
+
+    for (size_t offset = 0u; offset < table->mapping_size; offset += (size_t)((page_size > 0) ? page_size : 4096))
+    {
+        checksum ^= mapping[offset];
+    }
+
+    (void)checksum;
+}
+
+/* has to be called with registry mutex held, tables in use are never evicted */
+static void QueensPermutationsRegistry_EvictToBudget(void)
+{
+    const size_t budget = global_config.permutations_registry_budget;
+
+    while ((budget != 0u) &&
+           (QueensPermutationsRegistry_stats.resident_size > budget))
+    {
+        QueensPermutationsRegistry_Entry_t* victim = NULL;
+
+        for (uint8 board_size = QUEENS_MIN_BOARD_SIZE; board_size <= QUEENS_MAX_BOARD_SIZE; board_size++)
+        {
+            QueensPermutationsRegistry_Entry_t* entry = &QueensPermutationsRegistry_entries[board_size];
+
+            if ((entry->state == QUEENS_PERMUTATIONS_REGISTRY_READY) &&
+                (entry->references_count == 0u) &&
+                ((victim == NULL) || (entry->last_use < victim->last_use)))
+            {
+                victim = entry;
+            }
+        }
+
+        if (victim == NULL)
+        {
+            break;
+        }
+
+        QueensPermutationsRegistry_Evict(victim);
+    }
+}
+
+static void QueensPermutationsRegistry_Evict(QueensPermutationsRegistry_Entry_t* entry)
+{
+    debug_print("Permutations registry: evicting table for board size %u (%zu bytes)\n", entry->table.board_size, entry->size);
+
+    (void)QueensPermutations_FreeResult(&entry->table);
+    QueensPermutationsRegistry_stats.resident_size -= entry->size;
+    QueensPermutationsRegistry_stats.evictions++;
+
+    entry->table = (QueensPermutations_Result_t){ 0 };
+    entry->size = 0u;
+    entry->state = QUEENS_PERMUTATIONS_REGISTRY_EMPTY;
+}
+
+static size_t QueensPermutationsRegistry_GetTableSize(const QueensPermutations_Result_t* const table)
+{
+    if (table->prefix_tree == true)
+    {
+        return table->tree_size;
+    }
+
+    if (table->mapping != NULL)
+    {
+        return table->mapping_size;
+    }
+
+    const size_t columns_count = (size_t)table->boards_count * table->board_size;
+
+    return (table->packed == true) ? ((columns_count + 1u) / 2u) : columns_count;
+}
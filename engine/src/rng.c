@@ -2,11 +2,12 @@
 
 /* PCG Random Number Generator */
 
-/* PCG state */
-static uint64 state = 0x853c49e6748fea9bULL;  /* Default seed */
+/* PCG state, per thread so that threads don't share (and race on) one sequence */
 static constexpr uint64 multiplier = 6364136223846793005ULL;
 static constexpr uint64 seed_multiplier = 5291759402843659291ULL; /* to make first number more randomized */
-static constexpr uint64 increment = 1442695040888963407ULL;
+static constexpr uint64 default_increment = 1442695040888963407ULL;
+static thread_local uint64 state = 0x853c49e6748fea9bULL;  /* Default seed */
+static thread_local uint64 increment = default_increment;
 
 /* Seed the PCG RNG */
 void RNG_Seed(uint64 seed)
@@ -14,15 +15,31 @@ void RNG_Seed(uint64 seed)
     state = seed*seed_multiplier;
 }
 
-uint64 RNG_Random_u64()
+/* every odd increment gives a different sequence, stream 0 is the default one */
+void RNG_SeedStream(uint64 seed, uint64 stream)
 {
-    uint64 oldstate = state;
-    state = oldstate * multiplier + increment;
+    increment = default_increment + (stream << 1u);
+    state = seed*seed_multiplier;
+}
 
-    uint64 xorshifted = ((oldstate >> 18u) ^ oldstate) >> 27u;
-    uint64 rot = oldstate >> 59u;
+RNG_State_t RNG_GetState(void)
+{
+    return (RNG_State_t){ .state = state, .increment = increment };
+}
+
+void RNG_SetState(const RNG_State_t rng_state)
+{
+    state = rng_state.state;
+    increment = rng_state.increment;
+}
+
+uint64 RNG_Random_u64()
+{
+    /* PCG step yields 32 good bits, shifting them into 64 bits leaves low bits badly distributed */
+    uint64 high = RNG_Random_u32();
+    uint64 low = RNG_Random_u32();
 
-    return (xorshifted >> rot) | (xorshifted << ((-rot) & 63));
+    return (high << 32u) | low;
 }
 
 uint32 RNG_Random_u32()
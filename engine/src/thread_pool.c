@@ -0,0 +1,56 @@
+#include <thread_pool.h>
+#include <assert.h>
+#include <pthread.h>
+#include <unistd.h>
+
+uint8 ThreadPool_GetThreadsCount(uint8 threads_count, const size_t jobs_count)
+{
+    if (threads_count == 0u)
+    {
+        /* auto - one thread per online core */
+        long cores_count = sysconf(_SC_NPROCESSORS_ONLN);
+        threads_count = (uint8)((cores_count > 0) ? ((cores_count < THREAD_POOL_MAX_THREADS) ? cores_count : THREAD_POOL_MAX_THREADS) : 1);
+    }
+
+    if (threads_count > THREAD_POOL_MAX_THREADS)
+    {
+        threads_count = THREAD_POOL_MAX_THREADS;
+    }
+
+    /* no thread would have anything to do */
+    if (threads_count > jobs_count)
+    {
+        threads_count = (jobs_count > 0u) ? (uint8)jobs_count : 1u;
+    }
+
+    return threads_count;
+}
+
+void ThreadPool_Run(const ThreadPool_Worker_t worker, void* const jobs, const size_t job_size, const uint8 jobs_count)
+{
+    assert(jobs_count <= THREAD_POOL_MAX_THREADS);
+
+    pthread_t threads[THREAD_POOL_MAX_THREADS];
+    bool thread_started[THREAD_POOL_MAX_THREADS] = { false };
+
+    for (uint8 job_idx = 1u; job_idx < jobs_count; job_idx++)
+    {
+        thread_started[job_idx] = (pthread_create(&threads[job_idx], NULL, worker, (uint8*)jobs + (size_t)job_idx * job_size) == 0);
+    }
+
+    for (uint8 job_idx = 0u; job_idx < jobs_count; job_idx++)
+    {
+        if (thread_started[job_idx] == false)
+        {
+            (void)worker((uint8*)jobs + (size_t)job_idx * job_size);
+        }
+    }
+
+    for (uint8 job_idx = 1u; job_idx < jobs_count; job_idx++)
+    {
+        if (thread_started[job_idx] == true)
+        {
+            pthread_join(threads[job_idx], NULL);
+        }
+    }
+}